@@ -0,0 +1,168 @@
+/**
+ * @file AsyncReader.hpp
+ * @brief asynchronous file reads: a queue of large reads is kept in flight across files (io_uring on Linux,
+ * a pool of threads calling pread otherwise) and the filled buffers are handed to parser workers.
+ * buffers are recycled through a fixed pool so the memory used for I/O does not grow with the input
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace DF
+{
+    /**
+     * @brief settings of AsyncReader, the memory used for I/O is (queue_depth + n_workers) * buffer_size
+     *
+     */
+    struct AsyncReadOptions
+    {
+        /**
+         * @brief number of reads in flight
+         *
+         */
+        std::size_t queue_depth = 16;
+
+        /**
+         * @brief size of each read and of each buffer of the pool
+         *
+         */
+        std::size_t buffer_size = 1 << 22;
+
+        /**
+         * @brief number of threads handling the filled buffers (0 uses default_n_threads())
+         *
+         */
+        std::size_t n_workers = 0;
+
+        /**
+         * @brief use io_uring when the kernel supports it, the thread pool is used otherwise
+         *
+         */
+        bool use_io_uring = true;
+
+        /**
+         * @brief DataFrame::read_files reads files smaller than this in total with a plain ifstream,
+         * starting the workers and the buffer pool costs more than it saves on small inputs
+         *
+         */
+        std::size_t min_async_size = 1 << 24;
+    };
+
+    /**
+     * @brief set the options used by DataFrame::read_files and read_lines_async by default
+     *
+     */
+    void set_async_read_options(AsyncReadOptions const& options);
+    AsyncReadOptions get_async_read_options();
+
+    /**
+     * @brief a part of a file read into a buffer of the pool, only valid during the call to the consumer
+     *
+     */
+    struct ReadChunk
+    {
+        std::size_t i_file;
+
+        /**
+         * @brief position of the chunk in its file and number of chunks of the file
+         *
+         */
+        std::size_t i_chunk;
+        std::size_t n_chunks;
+
+        std::uint64_t offset;
+        std::string_view data;
+    };
+
+    /**
+     * @brief fixed number of buffers of the same size, acquire waits until a buffer is released
+     *
+     */
+    class BufferPool
+    {
+        public:
+            BufferPool(std::size_t n_buffers, std::size_t buffer_size);
+
+            char* acquire();
+
+            /**
+             * @brief a free buffer, or nullptr if all buffers are in use
+             *
+             */
+            char* try_acquire();
+
+            void release(char* buffer);
+
+        private:
+            std::unique_ptr<char[]> memory;
+            std::vector<char*> free_buffers;
+            std::mutex mutex;
+            std::condition_variable is_released;
+    };
+
+    class AsyncReader
+    {
+        public:
+            using Consumer = std::function<void(ReadChunk const&)>;
+
+            explicit AsyncReader(AsyncReadOptions options = get_async_read_options());
+
+            /**
+             * @brief read regular files in chunks of buffer_size bytes, the chunks of all files are read ahead
+             * and passed to consumer by the worker threads, in any order and concurrently.
+             * the first error (of a read or of the consumer) stops the reads and is rethrown
+             *
+             * @param paths paths to the files
+             * @param consumer called once per chunk
+             */
+            void read(std::vector<std::string> const& paths, Consumer const& consumer);
+
+            /**
+             * @brief whether the last read used io_uring
+             *
+             */
+            bool uses_io_uring() const;
+
+        private:
+            AsyncReadOptions options;
+            bool is_io_uring = false;
+    };
+
+    /**
+     * @brief read the non-empty lines of files ('\r' removed, like DataFrame::read_lines),
+     * the chunks are read with AsyncReader and split into lines in parallel
+     *
+     * @param paths paths to the files
+     * @param options
+     * @return the lines of each file
+     */
+    std::vector<std::vector<std::string>> read_lines_async(std::vector<std::string> const& paths, AsyncReadOptions const& options = get_async_read_options());
+
+    using LineParser = std::function<std::vector<std::string>(std::string const& line)>;
+
+    /**
+     * @brief like read_lines_async, but each line is also split into cells by the worker which received
+     * its chunk, so parsing overlaps with the reads still in flight
+     *
+     * @param paths paths to the files
+     * @param parse splits a line into cells, called concurrently
+     * @param options
+     * @return the rows of each file
+     */
+    std::vector<std::vector<std::vector<std::string>>> read_rows_async(std::vector<std::string> const& paths, LineParser const& parse,
+                                                                       AsyncReadOptions const& options = get_async_read_options());
+}
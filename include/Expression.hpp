@@ -0,0 +1,491 @@
+/**
+ * @file Expression.hpp
+ * @brief expression templates for deriving columns of a DataFrame,
+ * e.g. df.eval(col("Cartn_x") * 2 + col("Cartn_y"))
+ * the operators are fused into a single loop without temporaries for intermediate results,
+ * but each referenced column is first parsed once into a std::vector<T> because the cells are stored as strings.
+ * integral results have no missing value: casting NaN or an out of range value to an integral type,
+ * and integral division or modulo by zero (or of the minimum value by -1) throw instead
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include "ReadFiles.hpp"
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "TypedColumn.hpp"
+
+namespace DF
+{
+    namespace expr
+    {
+        /**
+         * @brief length of an expression which does not depend on any column (e.g. a scalar)
+         *
+         */
+        inline constexpr std::size_t any_size = std::numeric_limits<std::size_t>::max();
+
+        /**
+         * @brief columns converted during binding, so each column is parsed once per evaluation
+         * even if it appears several times in the expression
+         *
+         */
+        using BindCache = std::unordered_map<std::string, std::shared_ptr<void>>;
+
+        /**
+         * @brief base class of all expression nodes, only used for detection
+         *
+         */
+        struct ExprBase {};
+
+        template<typename E>
+        inline constexpr bool is_expr_v = std::is_base_of_v<ExprBase, std::decay_t<E>>;
+
+        /**
+         * @brief merge the length of two sub-expressions
+         *
+         */
+        inline std::size_t merge_sizes(std::size_t lhs, std::size_t rhs)
+        {
+            if(lhs == any_size) return rhs;
+            if(rhs == any_size || lhs == rhs) return lhs;
+
+            throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: columns of different length ({} and {}) in expression", lhs, rhs));
+        }
+
+        /**
+         * @brief leaf node refering to a column of the DataFrame, converted to T while binding
+         * (the whole column is parsed into a vector shared through the BindCache)
+         *
+         * @tparam T element type of the column
+         */
+        template<typename T>
+        struct ColumnExpr : ExprBase
+        {
+            using value_type = T;
+
+            std::string hdr;
+            std::shared_ptr<std::vector<T>> values;
+            T const* ptr = nullptr;
+
+            explicit ColumnExpr(std::string h) : hdr(std::move(h)) {}
+
+            void bind(DataFrame const& df, BindCache& cache)
+            {
+                std::string key = hdr + '\0' + typeid(T).name();
+                auto it = cache.find(key);
+                if(it == cache.end())
+                {
+                    auto parsed = std::make_shared<std::vector<T>>(parse_column<T>(df.at(hdr), hdr));
+                    it = cache.emplace(key, parsed).first;
+                }
+                values = std::static_pointer_cast<std::vector<T>>(it->second);
+                ptr = values->data();
+            }
+
+            std::size_t size() const { return values->size(); }
+
+            T operator[](std::size_t i) const { return ptr[i]; }
+        };
+
+        /**
+         * @brief leaf node holding a constant
+         *
+         */
+        template<typename T>
+        struct ScalarExpr : ExprBase
+        {
+            using value_type = T;
+
+            T value;
+
+            explicit ScalarExpr(T v) : value(v) {}
+
+            void bind(DataFrame const&, BindCache&) {}
+
+            std::size_t size() const { return any_size; }
+
+            T operator[](std::size_t) const { return value; }
+        };
+
+        /**
+         * @brief node applying Op on one sub-expression
+         *
+         */
+        template<typename Op, typename E>
+        struct UnaryExpr : ExprBase
+        {
+            using value_type = decltype(std::declval<Op>()(std::declval<typename E::value_type>()));
+
+            Op op;
+            E e;
+
+            UnaryExpr(Op o, E ex) : op(o), e(std::move(ex)) {}
+
+            void bind(DataFrame const& df, BindCache& cache) { e.bind(df, cache); }
+
+            std::size_t size() const { return e.size(); }
+
+            value_type operator[](std::size_t i) const { return op(e[i]); }
+        };
+
+        /**
+         * @brief node applying Op on two sub-expressions
+         *
+         */
+        template<typename Op, typename L, typename R>
+        struct BinaryExpr : ExprBase
+        {
+            using value_type = decltype(std::declval<Op>()(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()));
+
+            Op op;
+            L l;
+            R r;
+
+            BinaryExpr(Op o, L lhs, R rhs) : op(o), l(std::move(lhs)), r(std::move(rhs)) {}
+
+            void bind(DataFrame const& df, BindCache& cache)
+            {
+                l.bind(df, cache);
+                r.bind(df, cache);
+            }
+
+            std::size_t size() const { return merge_sizes(l.size(), r.size()); }
+
+            value_type operator[](std::size_t i) const { return op(l[i], r[i]); }
+        };
+
+        /**
+         * @brief node selecting from two sub-expressions based on a condition
+         *
+         */
+        template<typename C, typename A, typename B>
+        struct WhereExpr : ExprBase
+        {
+            using value_type = std::common_type_t<typename A::value_type, typename B::value_type>;
+
+            C cond;
+            A a;
+            B b;
+
+            WhereExpr(C c, A lhs, B rhs) : cond(std::move(c)), a(std::move(lhs)), b(std::move(rhs)) {}
+
+            void bind(DataFrame const& df, BindCache& cache)
+            {
+                cond.bind(df, cache);
+                a.bind(df, cache);
+                b.bind(df, cache);
+            }
+
+            std::size_t size() const { return merge_sizes(cond.size(), merge_sizes(a.size(), b.size())); }
+
+            value_type operator[](std::size_t i) const
+            {
+                return cond[i] ? static_cast<value_type>(a[i]) : static_cast<value_type>(b[i]);
+            }
+        };
+
+        /**
+         * @brief wrap scalars into ScalarExpr and leave expressions as they are
+         *
+         */
+        template<typename T>
+        auto as_expr(T const& value)
+        {
+            if constexpr (is_expr_v<T>)
+            {
+                return value;
+            }
+            else
+            {
+                static_assert(std::is_arithmetic_v<T>, "only arithmetic scalars can be used in expressions");
+                return ScalarExpr<T>(value);
+            }
+        }
+
+        template<typename L, typename R>
+        inline constexpr bool is_binary_operand_v = (is_expr_v<L> || is_expr_v<R>) &&
+                                                    (is_expr_v<L> || std::is_arithmetic_v<L>) &&
+                                                    (is_expr_v<R> || std::is_arithmetic_v<R>);
+
+        template<typename Op, typename L, typename R>
+        auto make_binary(Op op, L const& lhs, R const& rhs)
+        {
+            auto l = as_expr(lhs);
+            auto r = as_expr(rhs);
+            return BinaryExpr<Op, decltype(l), decltype(r)>(op, std::move(l), std::move(r));
+        }
+
+        /**
+         * @brief reference a column of the DataFrame inside an expression,
+         * missing values are NaN for floating point T and an error for integral T
+         *
+         * @tparam T element type the column is converted to (default double)
+         * @param hdr header of the column
+         * @return ColumnExpr<T>
+         */
+        template<typename T = double>
+        ColumnExpr<T> col(std::string hdr)
+        {
+            return ColumnExpr<T>(std::move(hdr));
+        }
+
+        /**
+         * @brief a constant inside an expression
+         *
+         */
+        template<typename T>
+        ScalarExpr<T> lit(T value)
+        {
+            return ScalarExpr<T>(value);
+        }
+
+        /**
+         * @brief static_cast to T, a floating point value which is NaN or out of the range of an integral T
+         * is an error instead of undefined behaviour
+         *
+         */
+        template<typename T>
+        struct cast_op
+        {
+            template<typename V>
+            T operator()(V v) const
+            {
+                if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> && std::is_floating_point_v<V>)
+                {
+                    // the bounds are powers of two, so they are exact as floating point values
+                    constexpr V lower = static_cast<V>(std::numeric_limits<T>::min());
+                    constexpr V upper = static_cast<V>(std::numeric_limits<T>::max() / 2 + 1) * 2;
+                    bool is_in_range = std::is_signed_v<T> ? v >= lower && v < upper : v > V(-1) && v < upper;
+                    if(!is_in_range)
+                    {
+                        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: {} cannot be cast to an integral type in expression", v));
+                    }
+                }
+                return static_cast<T>(v);
+            }
+        };
+
+        /**
+         * @brief convert the values of an expression to T,
+         * NaN or out of range values cast to an integral type throw
+         *
+         */
+        template<typename T, typename E, typename = std::enable_if_t<is_expr_v<E>>>
+        auto cast(E const& e)
+        {
+            return UnaryExpr<cast_op<T>, E>(cast_op<T>{}, e);
+        }
+
+        /**
+         * @brief element-wise cond ? a : b
+         *
+         */
+        template<typename C, typename A, typename B, typename = std::enable_if_t<is_expr_v<C>>>
+        auto where(C const& cond, A const& a, B const& b)
+        {
+            auto ea = as_expr(a);
+            auto eb = as_expr(b);
+            return WhereExpr<C, decltype(ea), decltype(eb)>(cond, std::move(ea), std::move(eb));
+        }
+
+        /**
+         * @brief integral division and modulo throw on a zero divisor and on the overflow of min / -1,
+         * floating point operands follow IEEE 754 (inf or NaN)
+         *
+         */
+        template<typename A, typename B>
+        void check_integral_divisor(A a, B b)
+        {
+            if constexpr (std::is_integral_v<std::common_type_t<A, B>>)
+            {
+                using C = std::common_type_t<A, B>;
+                if(b == 0)
+                {
+                    throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: integral division by zero in expression"));
+                }
+                if constexpr (std::is_signed_v<C>)
+                {
+                    if(static_cast<C>(a) == std::numeric_limits<C>::min() && static_cast<C>(b) == C(-1))
+                    {
+                        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: integral division of {} by -1 overflows in expression", a));
+                    }
+                }
+            }
+        }
+
+        struct divides_op
+        {
+            template<typename A, typename B>
+            auto operator()(A a, B b) const
+            {
+                check_integral_divisor(a, b);
+                return a / b;
+            }
+        };
+
+        struct modulus_op
+        {
+            template<typename A, typename B>
+            auto operator()(A a, B b) const
+            {
+                check_integral_divisor(a, b);
+                return a % b;
+            }
+        };
+
+#define DF_EXPR_BINARY_OPERATOR(OP, FUNCTOR)                                        \
+        template<typename L, typename R, typename = std::enable_if_t<is_binary_operand_v<L, R>>> \
+        auto operator OP(L const& lhs, R const& rhs)                                \
+        {                                                                           \
+            return make_binary(FUNCTOR{}, lhs, rhs);                                \
+        }
+
+        DF_EXPR_BINARY_OPERATOR(+, std::plus<>)
+        DF_EXPR_BINARY_OPERATOR(-, std::minus<>)
+        DF_EXPR_BINARY_OPERATOR(*, std::multiplies<>)
+        DF_EXPR_BINARY_OPERATOR(/, divides_op)
+        DF_EXPR_BINARY_OPERATOR(%, modulus_op)
+        DF_EXPR_BINARY_OPERATOR(==, std::equal_to<>)
+        DF_EXPR_BINARY_OPERATOR(!=, std::not_equal_to<>)
+        DF_EXPR_BINARY_OPERATOR(<, std::less<>)
+        DF_EXPR_BINARY_OPERATOR(<=, std::less_equal<>)
+        DF_EXPR_BINARY_OPERATOR(>, std::greater<>)
+        DF_EXPR_BINARY_OPERATOR(>=, std::greater_equal<>)
+        DF_EXPR_BINARY_OPERATOR(&&, std::logical_and<>)
+        DF_EXPR_BINARY_OPERATOR(||, std::logical_or<>)
+
+#undef DF_EXPR_BINARY_OPERATOR
+
+        template<typename E, typename = std::enable_if_t<is_expr_v<E>>>
+        auto operator-(E const& e)
+        {
+            return UnaryExpr<std::negate<>, E>(std::negate<>{}, e);
+        }
+
+        template<typename E, typename = std::enable_if_t<is_expr_v<E>>>
+        auto operator!(E const& e)
+        {
+            return UnaryExpr<std::logical_not<>, E>(std::logical_not<>{}, e);
+        }
+
+#define DF_EXPR_MATH_FUNCTION(NAME)                                                 \
+        struct NAME##_op                                                            \
+        {                                                                           \
+            template<typename T>                                                    \
+            auto operator()(T v) const { return std::NAME(v); }                     \
+        };                                                                          \
+                                                                                    \
+        template<typename E, typename = std::enable_if_t<is_expr_v<E>>>             \
+        auto NAME(E const& e)                                                       \
+        {                                                                           \
+            return UnaryExpr<NAME##_op, E>(NAME##_op{}, e);                         \
+        }
+
+        DF_EXPR_MATH_FUNCTION(abs)
+        DF_EXPR_MATH_FUNCTION(sqrt)
+        DF_EXPR_MATH_FUNCTION(exp)
+        DF_EXPR_MATH_FUNCTION(log)
+        DF_EXPR_MATH_FUNCTION(log10)
+        DF_EXPR_MATH_FUNCTION(sin)
+        DF_EXPR_MATH_FUNCTION(cos)
+        DF_EXPR_MATH_FUNCTION(tan)
+        DF_EXPR_MATH_FUNCTION(floor)
+        DF_EXPR_MATH_FUNCTION(ceil)
+        DF_EXPR_MATH_FUNCTION(round)
+
+#undef DF_EXPR_MATH_FUNCTION
+
+        struct pow_op
+        {
+            template<typename A, typename B>
+            auto operator()(A a, B b) const { return std::pow(a, b); }
+        };
+
+        template<typename L, typename R, typename = std::enable_if_t<is_binary_operand_v<L, R>>>
+        auto pow(L const& base, R const& exponent)
+        {
+            return make_binary(pow_op{}, base, exponent);
+        }
+
+        struct min_op
+        {
+            template<typename A, typename B>
+            auto operator()(A a, B b) const { return b < a ? b : a; }
+        };
+
+        struct max_op
+        {
+            template<typename A, typename B>
+            auto operator()(A a, B b) const { return a < b ? b : a; }
+        };
+
+        template<typename L, typename R, typename = std::enable_if_t<is_binary_operand_v<L, R>>>
+        auto min(L const& lhs, R const& rhs)
+        {
+            return make_binary(min_op{}, lhs, rhs);
+        }
+
+        template<typename L, typename R, typename = std::enable_if_t<is_binary_operand_v<L, R>>>
+        auto max(L const& lhs, R const& rhs)
+        {
+            return make_binary(max_op{}, lhs, rhs);
+        }
+
+        /**
+         * @brief element type used to store the result of an expression
+         * (bool is stored as std::uint8_t to keep the output contiguous)
+         *
+         */
+        template<typename T>
+        using storage_t = std::conditional_t<std::is_same_v<T, bool>, std::uint8_t, T>;
+    }
+}
+
+template<typename Expr>
+auto DF::DataFrame::eval(Expr const& expression) const
+{
+    using result_type = DF::expr::storage_t<typename Expr::value_type>;
+
+    // bind a copy, so the same expression can be evaluated on several data frames
+    Expr bound = expression;
+    DF::expr::BindCache cache;
+    bound.bind(*this, cache);
+
+    std::size_t n = bound.size();
+    if(n == DF::expr::any_size)
+    {
+        n = headers.empty() ? 0 : at(headers[0]).size();
+    }
+
+    // the whole expression tree is inlined into this single loop
+    std::vector<result_type> v_results(n);
+    result_type* out = v_results.data();
+    for(std::size_t i{0}; i < n; ++i)
+    {
+        out[i] = static_cast<result_type>(bound[i]);
+    }
+
+    return v_results;
+}
+
+template<typename Expr>
+void DF::DataFrame::eval(Expr const& expression, std::string hdr)
+{
+    add_col(eval(expression), hdr);
+}
@@ -0,0 +1,103 @@
+/**
+ * @file Follow.hpp
+ * @brief state of DataFrame::follow and the running aggregates updated when rows are appended
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace DF
+{
+    /**
+     * @brief what a followed file looked like at the previous refresh
+     *
+     */
+    struct FollowState
+    {
+        bool is_active = false;
+        std::string path;
+        char delim = ',';
+        bool is_first_col_header = true;
+        std::vector<std::string> v_hdrs;
+
+        /**
+         * @brief bytes of the file already parsed, always just after a newline
+         *
+         */
+        std::uint64_t offset = 0;
+
+        /**
+         * @brief device and inode of the file, and its first bytes already parsed,
+         * the file is loaded again when one of them changes (the file was replaced or rewritten)
+         *
+         */
+        bool has_file_id = false;
+        std::uint64_t device = 0;
+        std::uint64_t inode = 0;
+        std::string prefix;
+    };
+
+    /**
+     * @brief count, sum, min and max of the values of one group, missing values are not counted
+     *
+     */
+    struct RunningStats
+    {
+        std::uint64_t count = 0;
+        double sum = 0.0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+
+        void add(double value);
+        double mean() const;
+    };
+
+    /**
+     * @brief running statistics of a value column per group of a group column,
+     * updated with each appended row instead of being recomputed
+     *
+     */
+    class RunningAggregate
+    {
+        public:
+            RunningAggregate(std::string group, std::string value);
+
+            /**
+             * @brief add one row
+             *
+             * @param group value of the group column (ignored if the aggregate has no group column)
+             * @param value value of the value column (NaN for missing values)
+             */
+            void add(std::string_view group, double value);
+
+            /**
+             * @brief remove all rows
+             *
+             */
+            void clear();
+
+            std::string group_hdr;
+            std::string value_hdr;
+
+            /**
+             * @brief groups in the order they were first seen
+             *
+             */
+            std::vector<std::string> groups;
+            std::vector<RunningStats> stats;
+
+        private:
+            std::unordered_map<std::string, std::size_t> group_pos;
+    };
+}
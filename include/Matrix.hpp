@@ -0,0 +1,83 @@
+/**
+ * @file Matrix.hpp
+ * @brief dense double matrices exported from and imported into a DataFrame
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace DF
+{
+    /**
+     * @brief alignment in bytes of the buffers allocated by Matrix (a cache line, enough for AVX-512 loads)
+     *
+     */
+    inline constexpr std::size_t matrix_alignment = 64;
+
+    /**
+     * @brief order of the cells of a matrix in memory, row_major stores the values of a row next to each other
+     * (N x 3 coordinates as x0 y0 z0 x1 ...), col_major stores the values of a column next to each other
+     *
+     */
+    enum class Layout
+    {
+        row_major,
+        col_major
+    };
+
+    /**
+     * @brief contiguous n_rows x n_cols matrix of doubles in a buffer aligned to matrix_alignment
+     *
+     */
+    class Matrix
+    {
+        public:
+            Matrix() = default;
+
+            /**
+             * @brief allocate an uninitialized matrix
+             *
+             * @param n_rows number of rows
+             * @param n_cols number of columns
+             * @param layout order of the cells in memory
+             */
+            Matrix(std::size_t n_rows, std::size_t n_cols, Layout layout = Layout::row_major);
+
+            double* data() { return values.get(); }
+            double const* data() const { return values.get(); }
+            std::size_t rows() const { return n_rows; }
+            std::size_t cols() const { return n_cols; }
+            std::size_t size() const { return n_rows * n_cols; }
+            Layout layout() const { return cell_layout; }
+
+            double& operator()(std::size_t i_row, std::size_t i_col) { return values[offset(i_row, i_col)]; }
+            double operator()(std::size_t i_row, std::size_t i_col) const { return values[offset(i_row, i_col)]; }
+
+        private:
+            struct AlignedDelete
+            {
+                void operator()(double* ptr) const
+                {
+                    ::operator delete[](ptr, std::align_val_t(matrix_alignment));
+                }
+            };
+
+            std::unique_ptr<double[], AlignedDelete> values;
+            std::size_t n_rows = 0;
+            std::size_t n_cols = 0;
+            Layout cell_layout = Layout::row_major;
+
+            std::size_t offset(std::size_t i_row, std::size_t i_col) const
+            {
+                return cell_layout == Layout::row_major ? i_row * n_cols + i_col : i_col * n_rows + i_row;
+            }
+    };
+}
@@ -0,0 +1,126 @@
+/**
+ * @file Memory.hpp
+ * @brief memory resources used by DataFrame storage, memory accounting and the global soft limit
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+
+namespace DF
+{
+    /**
+     * @brief thrown when an allocation through a TrackingResource would exceed the soft memory limit
+     *
+     */
+    class memory_limit_error : public std::bad_alloc
+    {
+        public:
+            const char* what() const noexcept override
+            {
+                return "DataFrame memory limit exceeded";
+            }
+    };
+
+    /**
+     * @brief memory resource which counts the bytes allocated through it and enforces the soft limit
+     * set with set_memory_limit, every allocation is forwarded to the upstream resource
+     *
+     */
+    class TrackingResource : public std::pmr::memory_resource
+    {
+        public:
+            explicit TrackingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+            /**
+             * @brief bytes currently allocated through this resource
+             *
+             */
+            std::size_t allocated_bytes() const;
+
+            std::pmr::memory_resource* upstream_resource() const;
+
+        private:
+            std::pmr::memory_resource* upstream;
+            std::atomic<std::size_t> n_bytes{0};
+
+            void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+            void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+            bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override;
+    };
+
+    /**
+     * @brief the resource used by data frames which are constructed without one,
+     * it tracks all their allocations, arenas or pools can use it as upstream to be tracked too
+     *
+     * @return TrackingResource*
+     */
+    TrackingResource* default_resource();
+
+    /**
+     * @brief whether several threads may allocate through the resource at the same time:
+     * new_delete_resource, synchronized_pool_resource and tracking resources over one of them.
+     * parallel operations which allocate cells of a data frame (from_matrix, pivot, melt, transpose) run on one thread
+     * when its resource is not thread-safe, e.g. a monotonic_buffer_resource or an unsynchronized_pool_resource.
+     * a data frame on such a resource must not be used from several threads either
+     *
+     * @param mr
+     */
+    bool is_thread_safe(std::pmr::memory_resource const* mr);
+
+    /**
+     * @brief set the global soft limit in bytes for allocations through tracking resources (0 means no limit),
+     * loads which would exceed it fail with an error instead of exhausting the memory of the host.
+     * only the columns and cells (and the buffers of a load, see MemoryReservation) are counted,
+     * headers, map keys, indexes and other bookkeeping are allocated on the global heap outside of the limit
+     *
+     * @param bytes
+     */
+    void set_memory_limit(std::size_t bytes);
+
+    /**
+     * @brief Get the global soft limit in bytes (0 means no limit)
+     *
+     */
+    std::size_t get_memory_limit();
+
+    /**
+     * @brief bytes currently allocated through all tracking resources
+     *
+     */
+    std::size_t allocated_bytes();
+
+    /**
+     * @brief charges memory held outside of the tracking resources (e.g. the lines and cells of a file
+     * before they are stored in the columns) against the soft limit until it is destroyed
+     *
+     */
+    class MemoryReservation
+    {
+        public:
+            MemoryReservation() = default;
+            MemoryReservation(MemoryReservation const&) = delete;
+            MemoryReservation& operator=(MemoryReservation const&) = delete;
+            ~MemoryReservation();
+
+            /**
+             * @brief charge bytes more, throws memory_limit_error if they exceed the soft limit
+             *
+             * @param bytes
+             */
+            void add(std::size_t bytes);
+
+            std::size_t reserved_bytes() const;
+
+        private:
+            std::size_t n_bytes = 0;
+    };
+}
@@ -0,0 +1,53 @@
+/**
+ * @file MmcifReader.hpp
+ * @brief streaming reader for mmCIF (PDBx) files, one DataFrame per category
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include "ReadFiles.hpp"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace DF
+{
+    /**
+     * @brief one data_ block of a mmCIF file
+     * categories are stored by their name with the leading underscore (e.g. "_atom_site"),
+     * the headers of each DataFrame are the item names without the category (e.g. "Cartn_x")
+     *
+     */
+    struct CifBlock
+    {
+        std::string name;
+        std::unordered_map<std::string, DataFrame> categories;
+    };
+
+    /**
+     * @brief read all data blocks of a mmCIF file in one pass
+     * loop_ categories become one row per loop entry, single items become a data frame with one row,
+     * quoted values and ;-delimited text fields are kept as one cell without their delimiters
+     *
+     * @param path path to the mmCIF file
+     * @param categories categories to keep, e.g. {"_atom_site", "_struct_conn"} (empty keeps all),
+     * loops of other categories are skipped without tokenizing them
+     * @return std::vector<CifBlock> one entry per data_ block, in file order
+     */
+    std::vector<CifBlock> read_mmcif(std::string_view path, std::shorts::V_string const& categories = {});
+
+    /**
+     * @brief same as read_mmcif but for mmCIF content which is already in memory
+     *
+     * @param text content of a mmCIF file
+     * @param categories categories to keep (empty keeps all)
+     * @return std::vector<CifBlock>
+     */
+    std::vector<CifBlock> read_mmcif_text(std::string_view text, std::shorts::V_string const& categories = {});
+}
@@ -0,0 +1,105 @@
+/**
+ * @file Parallel.hpp
+ * @brief small helpers to split work over std::thread
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DF
+{
+    /**
+     * @brief number of threads used by parallel operations (at least 1)
+     *
+     */
+    inline std::size_t default_n_threads()
+    {
+        return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    /**
+     * @brief run fn(i) for i in [0, n_tasks) on up to n_threads threads, tasks are taken one by one
+     * so tasks of different sizes are balanced, the first exception is rethrown in the caller
+     *
+     * @param n_tasks number of tasks
+     * @param fn callable taking the task number
+     * @param n_threads number of threads (0 uses default_n_threads())
+     */
+    template<typename Fn>
+    void parallel_tasks(std::size_t n_tasks, Fn&& fn, std::size_t n_threads = 0)
+    {
+        if(n_threads == 0) n_threads = default_n_threads();
+        n_threads = std::min(n_threads, n_tasks);
+
+        if(n_threads <= 1)
+        {
+            for(std::size_t i{0}; i < n_tasks; ++i) fn(i);
+            return;
+        }
+
+        std::atomic<std::size_t> next{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        auto worker = [&]()
+        {
+            for(std::size_t i = next.fetch_add(1); i < n_tasks; i = next.fetch_add(1))
+            {
+                try
+                {
+                    fn(i);
+                }
+                catch(...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if(!error) error = std::current_exception();
+                    next.store(n_tasks);
+                }
+            }
+        };
+
+        std::vector<std::thread> v_threads;
+        v_threads.reserve(n_threads - 1);
+        for(std::size_t i{1}; i < n_threads; ++i) v_threads.emplace_back(worker);
+        worker();
+        for(auto& thread : v_threads) thread.join();
+
+        if(error) std::rethrow_exception(error);
+    }
+
+    /**
+     * @brief run fn(begin, end) on contiguous chunks of [0, n) in parallel,
+     * ranges smaller than min_chunk per thread are not split
+     *
+     * @param n size of the range
+     * @param fn callable taking the begin and end of a chunk
+     * @param min_chunk minimum number of elements per chunk
+     * @param n_threads number of threads (0 uses default_n_threads())
+     */
+    template<typename Fn>
+    void parallel_for(std::size_t n, Fn&& fn, std::size_t min_chunk = 1 << 14, std::size_t n_threads = 0)
+    {
+        if(n_threads == 0) n_threads = default_n_threads();
+        std::size_t n_chunks = std::max<std::size_t>(1, std::min(n_threads, n / std::max<std::size_t>(1, min_chunk)));
+        std::size_t chunk = (n + n_chunks - 1) / n_chunks;
+
+        parallel_tasks(n_chunks, [&](std::size_t i_chunk)
+        {
+            std::size_t begin = i_chunk * chunk;
+            std::size_t end = std::min(n, begin + chunk);
+            if(begin < end) fn(begin, end);
+        }, n_threads);
+    }
+}
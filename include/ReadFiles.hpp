@@ -16,12 +16,19 @@
 #include "fmt/color.h"
 #include "fmt/format.h"
 #include "fmt/os.h"
+#include "Follow.hpp"
 #include "fmt/ranges.h"
+#include "Matrix.hpp"
+#include <memory_resource>
+#include "Memory.hpp"
+#include "Reshape.hpp"
 #include <string>
 #include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
+#include "RowIndex.hpp"
+#include "TypedColumn.hpp"
 
 
 namespace std
@@ -36,15 +43,24 @@ namespace std
         using VV_string = vector<V_string>;
         using V_any = vector<any>;
         using VV_any =vector<vector<any>>;
-        using Data = unordered_map<string, V_string>;
+        using Column = pmr::vector<pmr::string>;
+        using Data = pmr::unordered_map<string, Column>;
         using V_double = vector<double>;
         using V_int = vector<int>;
         using V_pair_ints = std::vector<std::pair<int, int>>;
     }   
 }
 
+// Arrow C Data Interface structures, defined in ArrowCData.hpp
+struct ArrowArray;
+struct ArrowSchema;
+
 namespace DF
 {
+    // rolling statistics and window functions, defined in Window.hpp
+    class Rolling;
+    class Window;
+
     /**
      * @brief DataFrame is class for parsing data in a given file
      * with a give delimeter (default is comma ',').
@@ -54,18 +70,61 @@ namespace DF
     class DataFrame
     {
         public:
+
+            /**
+             * @brief construct an empty data frame which allocates through DF::default_resource()
+             * 
+             */
+            DataFrame();
+
+            /**
+             * @brief construct an empty data frame which allocates its columns and cells through mr,
+             * e.g. a std::pmr::monotonic_buffer_resource for short-lived frames
+             * 
+             * @param mr memory resource, must outlive the data frame
+             */
+            explicit DataFrame(std::pmr::memory_resource* mr);
+
+            /**
+             * @brief copy and move constructors allocate through the memory resource of other,
+             * assignments keep the resource of the assigned-to data frame (like std::pmr containers,
+             * the cells are copied into it when the resources differ, also by a move assignment)
+             * 
+             */
+            DataFrame(DataFrame const& other);
+            DataFrame(DataFrame&& other) = default;
+            DataFrame& operator=(DataFrame const& other) = default;
+            DataFrame& operator=(DataFrame&& other) = default;
+
+            /**
+             * @brief Get the memory resource of the data frame
+             * 
+             * @return std::pmr::memory_resource* 
+             */
+            std::pmr::memory_resource* get_memory_resource() const;
+
+            /**
+             * @brief memory used by each column and in total, an estimate of what the columns allocate through
+             * the memory resource: headers, map keys, the index and the aggregates live in std::string and
+             * std::vector on the global heap and are not counted
+             * 
+             * @param deep if true the heap buffers of the cells are counted too (capacity + 1 for each cell longer
+             * than the small string buffer of the standard library), otherwise only the columns
+             * @return DataFrame with the headers "column" and "bytes"
+             */
+            DataFrame memory_usage(bool deep = true) const;
             
             /**
              * @brief number of rows
              * 
              */
-            unsigned long long n_rows;
+            unsigned long long n_rows = 0;
 
             /**
              * @brief number of columns
              * 
              */
-            unsigned long long n_cols;            
+            unsigned long long n_cols = 0;            
 
             /**
              * @brief an unorderd maps for missing values
@@ -101,8 +160,22 @@ namespace DF
              */
             std::shorts::V_string get_headers() const;
 
+            /**
+             * @brief copy of a column as std::vector<std::string> (the type operator[] returned before the columns
+             * were stored in std::pmr containers), empty if the header does not exist
+             * 
+             * @param hdr header of the column
+             * @return std::shorts::V_string values of the column
+             */
+            std::shorts::V_string get_by_header(std::string const& hdr) const;
 
-            std::shorts::V_string get_by_header(std::string const& hdr);
+            /**
+             * @brief read-only access to a column, throws if the header does not exist
+             * 
+             * @param hdr header of the column
+             * @return std::shorts::Column const& values of the column
+             */
+            std::shorts::Column const& at(std::string const& hdr) const;
 
             /**
              * @brief to copy current data into new data frame
@@ -127,7 +200,8 @@ namespace DF
             void remove_duplications(std::string const& hdr);
 
             /**
-             * @brief read files 
+             * @brief read files, a regular file of at least min_async_size bytes (see AsyncReader.hpp) is read
+             * asynchronously and split into cells by the reader workers while the next chunks are read
              * 
              * @param path path to input file
              * @param delim delimiter for parsing the input file
@@ -135,6 +209,18 @@ namespace DF
              */
             void read_files(std::string_view path, char delim = ',', bool is_first_col_header = true, std::shorts::V_string v_hdrs = {});
 
+            /**
+             * @brief read several files with the same columns into one dataframe, the files are read
+             * asynchronously with the options of set_async_read_options (see AsyncReader.hpp)
+             * if they have at least min_async_size bytes in total, one after the other otherwise
+             * 
+             * @param paths paths to the input files
+             * @param delim delimiter for parsing the input files
+             * @param is_first_col_header whether each file starts with the same header line
+             * @param v_hdrs headers if the files have none
+             */
+            void read_files(std::shorts::V_string const& paths, char delim = ',', bool is_first_col_header = true, std::shorts::V_string v_hdrs = {});
+
             /**
              * @brief 
              * 
@@ -153,6 +239,71 @@ namespace DF
              */
             void read_text_whitespace(std::string const& text, bool is_first_col_header = true, std::shorts::V_string v_hdrs = {});
 
+            /**
+             * @brief read one category of a mmCIF file (see MmcifReader.hpp to read several categories or blocks at once)
+             * 
+             * @param path path to the mmCIF file
+             * @param category category to read (default _atom_site), headers are the item names of the loop
+             */
+            void read_mmcif(std::string_view path, std::string const& category = "_atom_site");
+
+            /**
+             * @brief load a file and keep following it, later calls to refresh only parse the lines appended since
+             * the previous load (a last line without newline is left for the next refresh)
+             * 
+             * @param path path to input file
+             * @param delim delimiter for parsing the input file (' ' splits on runs of whitespace)
+             * @param is_first_col_header boolean
+             * @param v_hdrs provided headers
+             */
+            void follow(std::string_view path, char delim = ',', bool is_first_col_header = true, std::shorts::V_string v_hdrs = {});
+
+            /**
+             * @brief append the complete lines written to the followed file since the previous load and update the
+             * tracked aggregates with them, a file which became shorter, was replaced (other device or inode)
+             * or whose first bytes changed is loaded again from the start
+             * 
+             * @return std::size_t number of new rows
+             */
+            std::size_t refresh();
+
+            /**
+             * @brief keep count, sum, mean, min and max of a value column per group up to date,
+             * the current rows are aggregated once and rows added by refresh or append update the result
+             * 
+             * @param value_hdr header of the numeric column
+             * @param group_hdr header of the group column (empty for a single group over all rows)
+             */
+            void track_aggregate(std::string const& value_hdr, std::string const& group_hdr = "");
+
+            /**
+             * @brief Get a tracked aggregate
+             * 
+             * @param value_hdr header of the numeric column
+             * @param group_hdr header of the group column (empty for a single group over all rows)
+             * @return DataFrame with one row per group and the headers (group_hdr,) count, sum, mean, min, max
+             */
+            DataFrame get_aggregate(std::string const& value_hdr, std::string const& group_hdr = "") const;
+
+            /**
+             * @brief rolling statistics of a numeric column over the last window rows (see Window.hpp)
+             * 
+             * @param hdr header of the numeric column
+             * @param window number of rows in each window
+             * @param min_periods minimum number of values in a window to get a result (0 means window)
+             * @return Rolling with sum, mean, min, max, std and count
+             */
+            Rolling rolling(std::string const& hdr, std::size_t window, std::size_t min_periods = 0) const;
+
+            /**
+             * @brief window functions over partitions of rows (see Window.hpp), the data frame must outlive the result
+             * 
+             * @param partition_by headers of the columns defining the partitions (empty for one partition)
+             * @param order_by headers of the columns ordering the rows of each partition (empty keeps the row order)
+             * @return Window with rank, row_number, lag, lead and cumsum
+             */
+            Window over(std::shorts::V_string const& partition_by, std::shorts::V_string const& order_by = {}) const;
+
             /**
              * @brief print n first rows off all columns
              * 
@@ -168,6 +319,38 @@ namespace DF
              */
             void swap_cols_pos(std::string first_hdr, std::string second_hdr);
 
+            /**
+             * @brief reshape long to wide: one row per distinct index value, one column per distinct columns value,
+             * cells without rows are NA. the input rows are scattered by output column and the columns are built in parallel
+             * 
+             * @param index_hdr header of the column giving the rows of the result
+             * @param columns_hdr header of the column giving the columns of the result
+             * @param values_hdr header of the column giving the cells of the result
+             * @param agg how values of rows with the same index and column are combined
+             * @return DataFrame with the headers index_hdr, then the distinct values of columns_hdr in order of appearance
+             */
+            DataFrame pivot(std::string const& index_hdr, std::string const& columns_hdr, std::string const& values_hdr, Aggregation agg = Aggregation::first) const;
+
+            /**
+             * @brief reshape wide to long: one row per row and value column, value columns are processed in parallel
+             * 
+             * @param id_vars headers of the columns repeated on each row
+             * @param value_vars headers of the columns to unpivot (empty for all columns not in id_vars)
+             * @param var_name header of the column holding the header of the value column
+             * @param value_name header of the column holding the value
+             * @return DataFrame with the headers id_vars, var_name, value_name
+             */
+            DataFrame melt(std::shorts::V_string const& id_vars, std::shorts::V_string const& value_vars = {},
+                           std::string const& var_name = "variable", std::string const& value_name = "value") const;
+
+            /**
+             * @brief swap rows and columns, the first column of the result ("column") holds the original headers
+             * 
+             * @param header_hdr column whose values become the headers of the result (empty for 1, 2, ...)
+             * @return DataFrame
+             */
+            DataFrame transpose(std::string const& header_hdr = "") const;
+
             /**
              * @brief add a column to the end of the dataframe based on a provided vector of string
              * 
@@ -176,6 +359,14 @@ namespace DF
              */
             void add_col(std::shorts::V_string const& v_values, std::string hdr = "new_col");
 
+            /**
+             * @brief add a column to the end of the dataframe by moving the provided values into it
+             * 
+             * @param v_strs vector of values to add  
+             * @param hdr given header name (default new: new_col), if the header is ther it would modified the header name
+             */
+            void add_col(std::shorts::V_string&& v_values, std::string hdr = "new_col");
+
            /**
             * @brief dd a column to the end of the dataframe based on a provided value for all rows
             * 
@@ -183,6 +374,37 @@ namespace DF
             * @param hdr given header name (default new: new_col), if the header is ther it would modified the header name
             */
             void add_col_of(std::string const& value, std::string hdr = "new_col");
+
+            /**
+             * @brief add a column of typed values (e.g. the result of eval), values are converted to strings
+             * 
+             * @tparam T arithmetic type
+             * @param values values to add
+             * @param hdr given header name (default new: new_col), if the header is ther it would modified the header name
+             */
+            template<typename T>
+            void add_col(std::vector<T> const& values, std::string hdr = "new_col");
+
+            /**
+             * @brief evaluate an expression built with DF::expr (see Expression.hpp) over all rows in one fused pass
+             * (after parsing each referenced column once), e.g. df.eval(col("Cartn_x") * 2 + col("Cartn_y"))
+             * 
+             * @tparam Expr expression type
+             * @param expression 
+             * @return std::vector of the element type of the expression (bool is returned as std::uint8_t)
+             */
+            template<typename Expr>
+            auto eval(Expr const& expression) const;
+
+            /**
+             * @brief evaluate an expression and add the result as a new column
+             * 
+             * @tparam Expr expression type
+             * @param expression 
+             * @param hdr header of the new column
+             */
+            template<typename Expr>
+            void eval(Expr const& expression, std::string hdr);
             
             /**
              * @brief check if headers are the same then append the values
@@ -198,12 +420,92 @@ namespace DF
             void clear();
 
             /**
-             * @brief subscript operator
+             * @brief build a hash or sorted index on the given key columns for lookups with loc,
+             * the index is maintained by append. it becomes stale when one of the key columns is accessed
+             * through the non-const operator[] (read with at() or the const operator[] instead),
+             * lookups on a stale index throw until reindex is called
+             * 
+             * @param v_hdrs headers of the key columns, e.g. {"label_asym_id", "label_seq_id", "label_atom_id"}
+             * @param type DF::IndexType::hash (default) or DF::IndexType::sorted
+             */
+            void set_index(std::shorts::V_string const& v_hdrs, IndexType type = IndexType::hash);
+
+            /**
+             * @brief remove the index
+             * 
+             */
+            void reset_index();
+
+            /**
+             * @brief rebuild a stale index on the current values of its key columns
+             * 
+             */
+            void reindex();
+
+            /**
+             * @brief Get the headers of the key columns of the index (empty if there is no index)
              * 
-             * @param hdr 
              * @return std::shorts::V_string 
              */
-            std::shorts::V_string& operator[](std::string hdr);
+            std::shorts::V_string get_index_headers() const;
+
+            /**
+             * @brief positions of the rows with the given key, the lookups do not modify the data frame
+             * so they may run concurrently
+             * 
+             * @param key one value for each key column
+             * @return std::vector<std::size_t> 
+             */
+            std::vector<std::size_t> find_rows(std::shorts::V_string const& key) const;
+
+            /**
+             * @brief check if at least one row has the given key
+             * 
+             * @param key one value for each key column
+             */
+            bool contains(std::shorts::V_string const& key) const;
+
+            /**
+             * @brief rows with the given key as a new data frame
+             * 
+             * @param key one value for each key column
+             * @return DataFrame 
+             */
+            DataFrame loc(std::shorts::V_string const& key) const;
+
+            /**
+             * @brief rows with first <= key <= last as a new data frame, ordered by key (needs a sorted index)
+             * 
+             * @param first lower bound of the keys (inclusive)
+             * @param last upper bound of the keys (inclusive)
+             * @return DataFrame 
+             */
+            DataFrame loc(std::shorts::V_string const& first, std::shorts::V_string const& last) const;
+
+            /**
+             * @brief copy the rows at the given positions into a new data frame
+             * 
+             * @param v_rows positions of the rows
+             * @return DataFrame 
+             */
+            DataFrame take(std::vector<std::size_t> const& v_rows) const;
+
+            /**
+             * @brief subscript operator, the column may be modified so an index on it becomes stale
+             * (see set_index), use at() or the const operator for reads
+             * 
+             * @param hdr 
+             * @return std::shorts::Column& 
+             */
+            std::shorts::Column& operator[](std::string hdr);
+
+            /**
+             * @brief read-only subscript operator, same as at()
+             * 
+             * @param hdr 
+             * @return std::shorts::Column const& 
+             */
+            std::shorts::Column const& operator[](std::string const& hdr) const;
 
             /**
              * @brief write the dataframe in a file with given path and delimiter  
@@ -219,10 +521,78 @@ namespace DF
              * @param path 
              */
             void save_as_csv(std::string_view path);
+
+            /**
+             * @brief export the dataframe through the Arrow C Data Interface (see ArrowCData.hpp) as a struct array
+             * with one child per column, columns are utf8 and the cells equal to one of null_values are nulls
+             * (the other cells, "?" and "." included, are exported as they are, or as NaN in numeric columns).
+             * the exported buffers are owned by the array and freed by its release callback,
+             * so they stay valid after the dataframe is modified or destroyed
+             * 
+             * @param array uninitialized ArrowArray to fill
+             * @param schema uninitialized ArrowSchema to fill
+             * @param numeric_hdrs columns exported as float64 instead of utf8
+             * @param null_values cells exported as nulls
+             */
+            void to_arrow(ArrowArray* array, ArrowSchema* schema, std::shorts::V_string const& numeric_hdrs = {}, std::shorts::V_string const& null_values = {"", "NA", "NAN"}) const;
+
+            /**
+             * @brief replace the dataframe by a struct array received through the Arrow C Data Interface,
+             * supports utf8, large utf8, bool, integer and floating point children.
+             * the array and schema are released after the import
+             * 
+             * @param array struct array
+             * @param schema schema of the array (format +s)
+             * @param null_value cell stored for the nulls
+             */
+            void from_arrow(ArrowArray* array, ArrowSchema* schema, std::string const& null_value = "NA");
+
+            /**
+             * @brief parse numeric columns into a contiguous matrix of doubles (missing values are NaN),
+             * large columns are parsed by several threads, throws if the columns have different lengths
+             * 
+             * @param hdrs headers of the columns, in the order of the matrix columns
+             * @param layout row_major (N x k, e.g. x y z per atom) or col_major
+             * @return Matrix aligned to matrix_alignment
+             */
+            Matrix to_matrix(std::shorts::V_string const& hdrs, Layout layout = Layout::row_major) const;
+
+            /**
+             * @brief parse numeric columns into a caller provided buffer
+             * 
+             * @param hdrs headers of the columns, in the order of the matrix columns
+             * @param out buffer of at least rows * hdrs.size() doubles
+             * @param layout row_major or col_major
+             */
+            void to_matrix(std::shorts::V_string const& hdrs, double* out, Layout layout = Layout::row_major) const;
+
+            /**
+             * @brief replace the dataframe by the columns of a matrix,
+             * the cells are stored as strings so the values are formatted (in parallel if the memory resource
+             * is thread-safe, see DF::is_thread_safe), not adopted
+             * 
+             * @param values buffer of rows * cols doubles
+             * @param rows number of rows
+             * @param cols number of columns
+             * @param hdrs headers of the columns (empty for 1, 2, ...)
+             * @param layout row_major or col_major
+             */
+            void from_matrix(double const* values, std::size_t rows, std::size_t cols, std::shorts::V_string const& hdrs = {}, Layout layout = Layout::row_major);
+
+            /**
+             * @brief replace the dataframe by the columns of a matrix
+             * 
+             * @param matrix 
+             * @param hdrs headers of the columns (empty for 1, 2, ...)
+             */
+            void from_matrix(Matrix const& matrix, std::shorts::V_string const& hdrs = {});
         
         private:
             std::shorts::Data data;
             std::shorts::V_string headers;
+            RowIndex index;
+            FollowState follow_state;
+            std::vector<RunningAggregate> aggregates;
 
             std::shorts::V_string read_lines(std::string_view path);
             std::shorts::V_string read_lines(std::string const& text);
@@ -232,7 +602,30 @@ namespace DF
             void fill_data_whitespace(std::shorts::V_string const& v_lines, bool is_first_col_header = true, std::shorts::V_string v_hdrs = {});
             void fill_data(std::shorts::V_string const& v_lines, char delim = ',', bool is_first_col_header = true, std::shorts::V_string v_hdrs = {});
             void fill_data(std::shorts::V_string const& v_lines, std::shorts::V_pair_ints const& v_cols_start_length, bool is_first_col_header = true, std::shorts::V_string v_hdrs = {});
-            void insert_col(std::shorts::V_string const& values, std::string hdr);
+            void fill_rows(std::shorts::VV_string const& vv_strs, bool is_first_col_header = true, std::shorts::V_string v_hdrs = {});
+            std::vector<std::shorts::VV_string> read_rows(std::shorts::V_string const& paths, char delim, DF::MemoryReservation& reservation);
+            void load_files(std::shorts::V_string const& paths, char delim, bool is_first_col_header, std::shorts::V_string v_hdrs);
+            void insert_col(std::shorts::Column values, std::string hdr);
+            [[noreturn]] void fail_load(std::string_view source);
+            void import_arrow(ArrowArray* array, ArrowSchema* schema, std::string const& null_value);
+            RowIndex::V_cols index_cols() const;
+            void check_index() const;
+            void mark_index_stale(std::string const& hdr);
+            void reset_state();
+            void update_aggregates(std::size_t first_row);
     };
     
-}
\ No newline at end of file
+}
+
+template<typename T>
+void DF::DataFrame::add_col(std::vector<T> const& values, std::string hdr)
+{
+    std::shorts::Column v_strs(get_memory_resource());
+    v_strs.reserve(values.size());
+    for(auto const& value : values)
+    {
+        v_strs.emplace_back(DF::to_cell(value));
+    }
+
+    insert_col(v_strs, hdr);
+}
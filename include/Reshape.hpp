@@ -0,0 +1,30 @@
+/**
+ * @file Reshape.hpp
+ * @brief options of the reshaping operations of a DataFrame (pivot, melt, transpose)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+namespace DF
+{
+    /**
+     * @brief how pivot combines the values of rows with the same index and column,
+     * first and last keep the cell as it is, the others parse numbers and skip missing values
+     *
+     */
+    enum class Aggregation
+    {
+        first,
+        last,
+        count,
+        sum,
+        mean,
+        min,
+        max
+    };
+}
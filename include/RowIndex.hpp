@@ -0,0 +1,147 @@
+/**
+ * @file RowIndex.hpp
+ * @brief hash or sorted index on one or more key columns of a DataFrame
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace DF
+{
+    /**
+     * @brief kind of row index
+     * hash: O(1) point lookups
+     * sorted: O(log n) point lookups and range slicing, key columns whose cells are all numbers
+     * (or missing) are compared numerically, the others as strings
+     *
+     */
+    enum class IndexType
+    {
+        hash,
+        sorted
+    };
+
+    /**
+     * @brief maps the values of the key columns of each row to its position
+     * the hash index stores a key of several columns as the cells joined by a unit separator,
+     * the sorted index orders rows by the first key column, then the second, ...
+     * with numbers by value and missing values last (so "10" comes after "9" and "1.0" matches "1")
+     *
+     */
+    class RowIndex
+    {
+        public:
+            using V_rows = std::vector<std::size_t>;
+            using V_cols = std::vector<std::pmr::vector<std::pmr::string> const*>;
+
+            /**
+             * @brief build the index over all rows of the key columns
+             *
+             * @param v_hdrs headers of the key columns
+             * @param v_cols the key columns, in the same order as v_hdrs
+             * @param type hash or sorted
+             */
+            void build(std::vector<std::string> const& v_hdrs, V_cols const& v_cols, IndexType type);
+
+            /**
+             * @brief add the rows [first_row, end) of the key columns to the index,
+             * used after rows were appended to the data frame
+             *
+             * @param v_cols the key columns, in the same order as the headers of the index
+             * @param first_row first row which is not indexed yet
+             */
+            void extend(V_cols const& v_cols, std::size_t first_row);
+
+            /**
+             * @brief remove the index
+             *
+             */
+            void clear();
+
+            /**
+             * @brief check if an index was built
+             *
+             */
+            bool empty() const;
+
+            /**
+             * @brief rows with the given key, in increasing order
+             *
+             * @param key one value for each key column
+             * @return V_rows
+             */
+            V_rows find(std::vector<std::string> const& key) const;
+
+            /**
+             * @brief check if at least one row has the given key
+             *
+             * @param key one value for each key column
+             */
+            bool contains(std::vector<std::string> const& key) const;
+
+            /**
+             * @brief rows with first <= key <= last, ordered by key (only for sorted indexes)
+             *
+             * @param first lower bound of the keys (inclusive)
+             * @param last upper bound of the keys (inclusive)
+             * @return V_rows
+             */
+            V_rows range(std::vector<std::string> const& first, std::vector<std::string> const& last) const;
+
+            /**
+             * @brief headers of the key columns
+             *
+             */
+            std::vector<std::string> const& get_headers() const;
+
+            IndexType get_type() const;
+
+            /**
+             * @brief an index is stale when its key columns may have been modified,
+             * e.g. after non-const access through DataFrame::operator[]
+             *
+             */
+            bool is_stale = false;
+
+        private:
+            std::vector<std::string> headers;
+            IndexType type = IndexType::hash;
+            std::size_t n_indexed = 0;
+            bool is_built = false;
+
+            /**
+             * @brief copy of a key column for the sorted index, as numbers while all its cells are numbers
+             *
+             */
+            struct SortedKey
+            {
+                bool is_numeric = true;
+                std::vector<double> numbers;
+                std::vector<std::string> strings;
+            };
+
+            std::unordered_multimap<std::string, std::size_t> hash_rows;
+            std::vector<SortedKey> sorted_keys;
+            std::vector<std::size_t> sorted_rows;
+
+            std::string make_key(std::vector<std::string> const& key) const;
+            std::string make_key(V_cols const& v_cols, std::size_t i_row) const;
+            void insert_rows(V_cols const& v_cols, std::size_t first_row);
+            int compare_rows(std::size_t lhs, std::size_t rhs) const;
+            int compare_to_key(std::size_t i_row, std::vector<double> const& numbers, std::vector<std::string> const& key) const;
+            bool parse_key(std::vector<std::string> const& key, std::vector<double>& numbers) const;
+            V_rows::const_iterator lower_bound(std::vector<double> const& numbers, std::vector<std::string> const& key) const;
+    };
+}
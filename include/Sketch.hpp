@@ -0,0 +1,248 @@
+/**
+ * @file Sketch.hpp
+ * @brief mergeable sketches with bounded memory for single pass statistics of inputs which do not fit in memory:
+ * HyperLogLog (number of distinct values), t-digest (quantiles) and Space-Saving (most frequent values)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "ReadFiles.hpp"
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace DF
+{
+    /**
+     * @brief sizes of the sketches, they bound the memory used per column
+     *
+     */
+    struct SketchOptions
+    {
+        /**
+         * @brief HyperLogLog uses 2^precision registers of one byte, the relative error is about 1.04 / sqrt(2^precision)
+         *
+         */
+        unsigned hll_precision = 12;
+
+        /**
+         * @brief t-digest keeps at most about 2 * compression centroids, larger values are more accurate
+         *
+         */
+        double compression = 100.0;
+
+        /**
+         * @brief number of values monitored by Space-Saving, values more frequent than n / n_counters are always found
+         *
+         */
+        std::size_t n_counters = 64;
+    };
+
+    /**
+     * @brief estimate of the number of distinct values
+     *
+     */
+    class HyperLogLog
+    {
+        public:
+            /**
+             * @brief
+             *
+             * @param precision between 4 and 18
+             */
+            explicit HyperLogLog(unsigned precision = 12);
+
+            void add(std::string_view value);
+
+            /**
+             * @brief add the values of another sketch with the same precision
+             *
+             */
+            void merge(HyperLogLog const& other);
+
+            double estimate() const;
+
+        private:
+            unsigned precision;
+            std::vector<std::uint8_t> registers;
+    };
+
+    /**
+     * @brief merging t-digest: clusters of values (centroids) which are smaller near the extremes,
+     * so tail quantiles are accurate. values are buffered and merged into the centroids in batches
+     *
+     */
+    class TDigest
+    {
+        public:
+            explicit TDigest(double compression = 100.0);
+
+            /**
+             * @brief add a value, NaN is ignored
+             *
+             */
+            void add(double value, double weight = 1.0);
+
+            void merge(TDigest const& other);
+
+            /**
+             * @brief estimate of the quantile q in [0, 1] (NaN if no value was added)
+             *
+             */
+            double quantile(double q) const;
+
+            /**
+             * @brief number of centroids after merging the buffered values, at most about 2 * compression
+             * whatever the number of values
+             *
+             */
+            std::size_t n_centroids() const;
+
+            double count() const;
+            double min() const;
+            double max() const;
+
+        private:
+            struct Centroid
+            {
+                double mean;
+                double weight;
+            };
+
+            double compression;
+            std::vector<Centroid> centroids;
+            std::vector<Centroid> buffer;
+            double total_weight = 0.0;
+            double min_value;
+            double max_value;
+
+            void compress();
+    };
+
+    /**
+     * @brief most frequent values, each monitored value has an upper bound of its count (count)
+     * and the maximum overestimation of that bound (error)
+     *
+     */
+    class SpaceSaving
+    {
+        public:
+            struct Counter
+            {
+                std::string value;
+                std::uint64_t count;
+                std::uint64_t error;
+            };
+
+            explicit SpaceSaving(std::size_t n_counters = 64);
+
+            void add(std::string_view value, std::uint64_t count = 1);
+
+            void merge(SpaceSaving const& other);
+
+            /**
+             * @brief the k monitored values with the largest counts, in decreasing order of count
+             *
+             */
+            std::vector<Counter> top(std::size_t k) const;
+
+        private:
+            std::size_t n_counters;
+            std::vector<Counter> counters;
+            std::unordered_map<std::string, std::size_t> positions;
+            std::set<std::pair<std::uint64_t, std::size_t>> by_count;
+            std::string key;
+
+            std::uint64_t min_count() const;
+    };
+
+    /**
+     * @brief all sketches of one column, cells which are numbers (as read by DF::parse_cell<double>) also go to the t-digest
+     *
+     */
+    class ColumnSketch
+    {
+        public:
+            explicit ColumnSketch(SketchOptions const& options = {});
+
+            void add(std::string_view cell);
+            void merge(ColumnSketch const& other);
+
+            std::uint64_t n_values = 0;
+            std::uint64_t n_missing = 0;
+            std::uint64_t n_numbers = 0;
+            HyperLogLog distinct;
+            TDigest numbers;
+            SpaceSaving frequent;
+    };
+
+    /**
+     * @brief sketches of the columns of data frames and files, fed in a single pass with several threads.
+     * columns are matched by header, so profiles of several files (or threads) can be merged
+     *
+     */
+    class Profile
+    {
+        public:
+            explicit Profile(SketchOptions options = {});
+
+            /**
+             * @brief add the rows of a data frame, blocks of rows are sketched in parallel
+             *
+             * @param df data frame (from any reader)
+             * @param hdrs headers of the columns to add (empty for all columns)
+             */
+            void add(DataFrame const& df, std::shorts::V_string const& hdrs = {});
+
+            /**
+             * @brief stream a delimited file in blocks without loading it, the lines of a block are sketched in parallel
+             *
+             * @param path path to the file
+             * @param delim delimiter (' ' for any whitespace)
+             * @param is_first_col_header whether the first line holds the headers
+             * @param v_hdrs headers if the file has none (empty for 1, 2, ...)
+             */
+            void add_file(std::string_view path, char delim = ',', bool is_first_col_header = true, std::shorts::V_string v_hdrs = {});
+
+            void merge(Profile const& other);
+
+            /**
+             * @brief one row per column with the headers
+             * column, count, missing, nunique, numbers, min, q25, median, q75, max
+             *
+             */
+            DataFrame summary() const;
+
+            /**
+             * @brief estimated quantiles of the numbers of a column, with the headers q, value
+             *
+             */
+            DataFrame quantiles(std::string const& hdr, std::shorts::V_double const& qs) const;
+
+            /**
+             * @brief most frequent values of a column, with the headers value, count, error
+             *
+             */
+            DataFrame top_k(std::string const& hdr, std::size_t k = 10) const;
+
+            ColumnSketch const& at(std::string const& hdr) const;
+            std::shorts::V_string get_headers() const;
+
+        private:
+            SketchOptions options;
+            std::shorts::V_string headers;
+            std::vector<ColumnSketch> sketches;
+
+            ColumnSketch& get_or_add(std::string const& hdr);
+    };
+}
@@ -0,0 +1,170 @@
+/**
+ * @file TypedColumn.hpp
+ * @brief helpers for converting string cells of a DataFrame into typed values and back
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include "fmt/color.h"
+#include "fmt/format.h"
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace DF
+{
+    /**
+     * @brief check if a cell is a missing value
+     * missing values are empty string, NA, NAN and the mmCIF placeholders ? and .
+     *
+     * @param cell std::string_view
+     * @return true if the cell is missing
+     */
+    inline bool is_missing(std::string_view cell)
+    {
+        return cell.empty() || cell == "NA" || cell == "NAN" || cell == "?" || cell == ".";
+    }
+
+    /**
+     * @brief remove the spaces around a cell
+     *
+     */
+    inline std::string_view trim_spaces(std::string_view cell)
+    {
+        while(!cell.empty() && cell.front() == ' ') cell.remove_prefix(1);
+        while(!cell.empty() && cell.back() == ' ') cell.remove_suffix(1);
+        return cell;
+    }
+
+    /**
+     * @brief parse one cell into a value of type T without throwing, with the rules of parse_cell
+     * (surrounding spaces and a leading plus sign are accepted, missing values are NaN for floating point types)
+     *
+     * @tparam T arithmetic type (bool, integral or floating point)
+     * @param cell std::string_view
+     * @param value parsed value, only set on success
+     * @return false if the cell is not a value of type T
+     */
+    template<typename T>
+    bool try_parse_cell(std::string_view cell, T& value)
+    {
+        static_assert(std::is_arithmetic_v<T>, "parse_cell only supports arithmetic types");
+
+        cell = trim_spaces(cell);
+
+        if(is_missing(cell))
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                value = std::numeric_limits<T>::quiet_NaN();
+                return true;
+            }
+            return false;
+        }
+
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            if(cell == "1" || cell == "true" || cell == "True" || cell == "TRUE") { value = true; return true; }
+            if(cell == "0" || cell == "false" || cell == "False" || cell == "FALSE") { value = false; return true; }
+            return false;
+        }
+        else
+        {
+            // from_chars does not accept a leading plus sign
+            if(cell.size() > 1 && cell.front() == '+') cell.remove_prefix(1);
+
+            T parsed{};
+            auto [ptr, ec] = std::from_chars(cell.data(), cell.data() + cell.size(), parsed);
+            if(ec != std::errc() || ptr != cell.data() + cell.size()) return false;
+
+            value = parsed;
+            return true;
+        }
+    }
+
+    /**
+     * @brief parse one cell into a value of type T
+     * missing values become NaN for floating point types, for other types they are an error
+     *
+     * @tparam T arithmetic type (bool, integral or floating point)
+     * @param cell std::string_view
+     * @param hdr header of the column (only used for the error message)
+     * @param i_row row of the cell (only used for the error message)
+     * @return T parsed value
+     */
+    template<typename T>
+    T parse_cell(std::string_view cell, std::string_view hdr = {}, std::size_t i_row = 0)
+    {
+        T value{};
+        if(try_parse_cell(cell, value)) return value;
+
+        cell = trim_spaces(cell);
+        if(is_missing(cell))
+        {
+            throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: missing value in column {} at row {} cannot be converted to an integral type", hdr, i_row + 1));
+        }
+
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: unable to convert \"{}\" in column {} at row {}", cell, hdr, i_row + 1));
+    }
+
+    /**
+     * @brief parse a whole column of string cells into a vector of T
+     *
+     * @tparam T arithmetic type
+     * @tparam Column any container of strings
+     * @param values column to convert
+     * @param hdr header of the column (only used for error messages)
+     * @return std::vector<T>
+     */
+    template<typename T, typename Column>
+    std::vector<T> parse_column(Column const& values, std::string_view hdr = {})
+    {
+        std::vector<T> v_values(values.size());
+        for(std::size_t i_row{0}; i_row < values.size(); ++i_row)
+        {
+            v_values[i_row] = parse_cell<T>(values[i_row], hdr, i_row);
+        }
+
+        return v_values;
+    }
+
+    /**
+     * @brief convert a typed value back into a string cell, NaN becomes NA
+     *
+     * @tparam T arithmetic type
+     * @param value
+     * @return std::string
+     */
+    template<typename T>
+    std::string to_cell(T value)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            if(std::isnan(value)) return "NA";
+        }
+
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            return value ? "1" : "0";
+        }
+        else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>)
+        {
+            return fmt::format("{}", static_cast<int>(value));
+        }
+        else
+        {
+            return fmt::format("{}", value);
+        }
+    }
+}
@@ -0,0 +1,140 @@
+/**
+ * @file Window.hpp
+ * @brief rolling (sliding window) statistics and partitioned window functions of a DataFrame
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include "ReadFiles.hpp"
+#include <string>
+#include <vector>
+
+namespace DF
+{
+    /**
+     * @brief statistics over a window of the last `window` rows, ending at each row,
+     * every step adds one value and removes one so each row costs O(1) (amortized for min and max).
+     * missing values are skipped, rows with fewer than min_periods values in their window are NaN
+     *
+     */
+    class Rolling
+    {
+        public:
+            /**
+             * @brief
+             *
+             * @param values values of the column (NaN for missing values)
+             * @param window number of rows in each window
+             * @param min_periods minimum number of values in a window (0 means window)
+             */
+            Rolling(std::shorts::V_double values, std::size_t window, std::size_t min_periods = 0);
+
+            std::shorts::V_double sum() const;
+            std::shorts::V_double mean() const;
+            std::shorts::V_double min() const;
+            std::shorts::V_double max() const;
+
+            /**
+             * @brief sample standard deviation (ddof = 1)
+             *
+             */
+            std::shorts::V_double std() const;
+
+            /**
+             * @brief number of values (not missing) in each window
+             *
+             */
+            std::shorts::V_double count() const;
+
+        private:
+            std::shorts::V_double values;
+            std::size_t window;
+            std::size_t min_periods;
+
+            template<typename IsBetter>
+            std::shorts::V_double extreme(IsBetter is_better) const;
+    };
+
+    /**
+     * @brief window functions evaluated per partition of rows sharing the same partition_by values,
+     * rows of a partition are ordered by the order_by columns (numerically if all cells of a column are numbers),
+     * partitions are processed in parallel. results are aligned with the rows of the data frame.
+     * the data frame must outlive the window
+     *
+     */
+    class Window
+    {
+        public:
+            /**
+             * @brief
+             *
+             * @param df data frame
+             * @param partition_by headers of the partition columns (empty for one partition)
+             * @param order_by headers of the order columns (empty keeps the order of the rows)
+             */
+            Window(DataFrame const& df, std::shorts::V_string const& partition_by, std::shorts::V_string const& order_by = {});
+
+            /**
+             * @brief 1-based position of each row in its partition
+             *
+             */
+            std::shorts::V_int row_number() const;
+
+            /**
+             * @brief 1-based rank of each row in its partition, rows with equal order_by values share the lowest rank
+             *
+             */
+            std::shorts::V_int rank() const;
+
+            /**
+             * @brief value of a column n rows before in the same partition
+             *
+             * @param hdr column
+             * @param n offset
+             * @param fill value when there is no such row
+             */
+            std::shorts::V_string lag(std::string const& hdr, std::size_t n = 1, std::string const& fill = "NA") const;
+
+            /**
+             * @brief value of a column n rows after in the same partition
+             *
+             * @param hdr column
+             * @param n offset
+             * @param fill value when there is no such row
+             */
+            std::shorts::V_string lead(std::string const& hdr, std::size_t n = 1, std::string const& fill = "NA") const;
+
+            /**
+             * @brief cumulative sum of a numeric column in each partition, missing values are skipped
+             *
+             */
+            std::shorts::V_double cumsum(std::string const& hdr) const;
+
+            /**
+             * @brief rolling statistics over the rows of each partition
+             *
+             */
+            std::shorts::V_double rolling_mean(std::string const& hdr, std::size_t window, std::size_t min_periods = 0) const;
+
+            /**
+             * @brief rows of each partition in their order
+             *
+             */
+            std::vector<std::vector<std::size_t>> const& get_partitions() const;
+
+        private:
+            DataFrame const* df;
+            std::vector<std::vector<std::size_t>> partitions;
+            std::vector<std::shorts::V_double> order_numbers;
+            std::vector<std::shorts::Column const*> order_strings;
+
+            bool is_tie(std::size_t lhs, std::size_t rhs) const;
+            std::shorts::V_string shift(std::string const& hdr, long long n, std::string const& fill) const;
+    };
+}
@@ -0,0 +1,358 @@
+#include <algorithm>
+#include "ArrowCData.hpp"
+#include "fmt/color.h"
+#include "fmt/format.h"
+#include <limits>
+#include <memory>
+#include "ReadFiles.hpp"
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+    /**
+     * @brief owns the format and name strings and the children of an exported schema
+     *
+     */
+    struct SchemaPrivate
+    {
+        std::string format;
+        std::string name;
+        std::vector<std::unique_ptr<ArrowSchema>> children;
+        std::vector<ArrowSchema*> children_ptrs;
+    };
+
+    /**
+     * @brief owns the buffers and the children of an exported array
+     *
+     */
+    struct ArrayPrivate
+    {
+        std::vector<std::uint8_t> validity;
+        std::vector<std::int32_t> offsets32;
+        std::vector<std::int64_t> offsets64;
+        std::string chars;
+        std::vector<double> values;
+        std::vector<void const*> buffers;
+        std::vector<std::unique_ptr<ArrowArray>> children;
+        std::vector<ArrowArray*> children_ptrs;
+    };
+
+    void release_schema(ArrowSchema* schema)
+    {
+        if(schema == nullptr || schema->release == nullptr) return;
+
+        auto* priv = static_cast<SchemaPrivate*>(schema->private_data);
+        for(auto* child : priv->children_ptrs)
+        {
+            if(child->release != nullptr) child->release(child);
+        }
+        delete priv;
+        schema->release = nullptr;
+    }
+
+    void release_array(ArrowArray* array)
+    {
+        if(array == nullptr || array->release == nullptr) return;
+
+        auto* priv = static_cast<ArrayPrivate*>(array->private_data);
+        for(auto* child : priv->children_ptrs)
+        {
+            if(child->release != nullptr) child->release(child);
+        }
+        delete priv;
+        array->release = nullptr;
+    }
+
+    void init_schema(ArrowSchema* schema, SchemaPrivate* priv)
+    {
+        schema->format = priv->format.c_str();
+        schema->name = priv->name.c_str();
+        schema->metadata = nullptr;
+        schema->flags = ARROW_FLAG_NULLABLE;
+        schema->n_children = static_cast<std::int64_t>(priv->children_ptrs.size());
+        schema->children = priv->children_ptrs.empty() ? nullptr : priv->children_ptrs.data();
+        schema->dictionary = nullptr;
+        schema->release = &release_schema;
+        schema->private_data = priv;
+    }
+
+    void init_array(ArrowArray* array, ArrayPrivate* priv, std::int64_t length, std::int64_t null_count)
+    {
+        array->length = length;
+        array->null_count = null_count;
+        array->offset = 0;
+        array->n_buffers = static_cast<std::int64_t>(priv->buffers.size());
+        array->n_children = static_cast<std::int64_t>(priv->children_ptrs.size());
+        array->buffers = priv->buffers.data();
+        array->children = priv->children_ptrs.empty() ? nullptr : priv->children_ptrs.data();
+        array->dictionary = nullptr;
+        array->release = &release_array;
+        array->private_data = priv;
+    }
+
+    bool is_null_value(std::string_view cell, std::shorts::V_string const& null_values)
+    {
+        return std::find(null_values.begin(), null_values.end(), cell) != null_values.end();
+    }
+
+    /**
+     * @brief export a column as utf8 (or large utf8 above 2 GB of characters), the cells in null_values become nulls
+     *
+     */
+    std::int64_t export_strings(std::shorts::Column const& values, std::shorts::V_string const& null_values, ArrayPrivate& priv, SchemaPrivate& schema_priv)
+    {
+        std::size_t n = values.size();
+        std::size_t n_chars = 0;
+        for(auto const& cell : values)
+        {
+            if(!is_null_value(cell, null_values)) n_chars += cell.size();
+        }
+
+        bool is_large = n_chars > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max());
+        schema_priv.format = is_large ? "U" : "u";
+
+        priv.validity.assign((n + 7) / 8, 0);
+        priv.chars.reserve(n_chars);
+        if(is_large) priv.offsets64.reserve(n + 1);
+        else priv.offsets32.reserve(n + 1);
+
+        std::int64_t null_count = 0;
+        for(std::size_t i{0}; i < n; ++i)
+        {
+            if(is_large) priv.offsets64.push_back(static_cast<std::int64_t>(priv.chars.size()));
+            else priv.offsets32.push_back(static_cast<std::int32_t>(priv.chars.size()));
+
+            if(is_null_value(values[i], null_values))
+            {
+                ++null_count;
+                continue;
+            }
+
+            priv.validity[i / 8] |= static_cast<std::uint8_t>(1u << (i % 8));
+            priv.chars.append(values[i]);
+        }
+        if(is_large) priv.offsets64.push_back(static_cast<std::int64_t>(priv.chars.size()));
+        else priv.offsets32.push_back(static_cast<std::int32_t>(priv.chars.size()));
+
+        priv.buffers = {null_count > 0 ? priv.validity.data() : nullptr,
+                        is_large ? static_cast<void const*>(priv.offsets64.data()) : static_cast<void const*>(priv.offsets32.data()),
+                        priv.chars.data()};
+
+        return null_count;
+    }
+
+    /**
+     * @brief export a column as float64, the cells in null_values become nulls,
+     * the other missing values (see DF::is_missing) become valid NaN
+     *
+     */
+    std::int64_t export_doubles(std::shorts::Column const& values, std::string const& hdr, std::shorts::V_string const& null_values, ArrayPrivate& priv, SchemaPrivate& schema_priv)
+    {
+        std::size_t n = values.size();
+        schema_priv.format = "g";
+
+        priv.validity.assign((n + 7) / 8, 0);
+        priv.values = DF::parse_column<double>(values, hdr);
+
+        std::int64_t null_count = 0;
+        for(std::size_t i{0}; i < n; ++i)
+        {
+            if(is_null_value(values[i], null_values))
+            {
+                ++null_count;
+                continue;
+            }
+            priv.validity[i / 8] |= static_cast<std::uint8_t>(1u << (i % 8));
+        }
+
+        priv.buffers = {null_count > 0 ? priv.validity.data() : nullptr, priv.values.data()};
+
+        return null_count;
+    }
+
+    bool is_valid(ArrowArray const* array, std::int64_t i)
+    {
+        if(array->null_count == 0 || array->n_buffers == 0 || array->buffers[0] == nullptr) return true;
+
+        auto const* bitmap = static_cast<std::uint8_t const*>(array->buffers[0]);
+        return (bitmap[i / 8] >> (i % 8)) & 1;
+    }
+
+    template<typename T>
+    void import_primitive(ArrowArray const* array, std::int64_t first, std::int64_t length, std::string const& null_value, std::shorts::Column& values)
+    {
+        auto const* data = static_cast<T const*>(array->buffers[1]);
+        for(std::int64_t i{0}; i < length; ++i)
+        {
+            std::int64_t j = first + i;
+            if(is_valid(array, j)) values[i] = DF::to_cell(data[j]);
+            else values[i] = null_value;
+        }
+    }
+
+    template<typename Offset>
+    void import_strings(ArrowArray const* array, std::int64_t first, std::int64_t length, std::string const& null_value, std::shorts::Column& values)
+    {
+        auto const* offsets = static_cast<Offset const*>(array->buffers[1]);
+        auto const* chars = static_cast<char const*>(array->buffers[2]);
+        for(std::int64_t i{0}; i < length; ++i)
+        {
+            std::int64_t j = first + i;
+            if(is_valid(array, j)) values[i].assign(chars + offsets[j], static_cast<std::size_t>(offsets[j + 1] - offsets[j]));
+            else values[i] = null_value;
+        }
+    }
+
+    /**
+     * @brief release the imported structures when leaving from_arrow, also on errors
+     *
+     */
+    struct ArrowReleaser
+    {
+        ArrowArray* array;
+        ArrowSchema* schema;
+
+        ~ArrowReleaser()
+        {
+            if(array != nullptr && array->release != nullptr) array->release(array);
+            if(schema != nullptr && schema->release != nullptr) schema->release(schema);
+        }
+    };
+}
+
+void DF::DataFrame::to_arrow(ArrowArray* array, ArrowSchema* schema, std::shorts::V_string const& numeric_hdrs, std::shorts::V_string const& null_values) const
+{
+    if(array == nullptr || schema == nullptr)
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: to_arrow needs a valid ArrowArray and ArrowSchema"));
+    }
+
+    std::int64_t length = headers.empty() ? 0 : static_cast<std::int64_t>(at(headers[0]).size());
+
+    auto schema_priv = std::make_unique<SchemaPrivate>();
+    auto array_priv = std::make_unique<ArrayPrivate>();
+    schema_priv->format = "+s";
+    schema_priv->children.reserve(headers.size());
+    schema_priv->children_ptrs.reserve(headers.size());
+    array_priv->children.reserve(headers.size());
+    array_priv->children_ptrs.reserve(headers.size());
+
+    // the children already exported own their private data through their release callbacks
+    auto release_children = [&]()
+    {
+        for(auto* child : schema_priv->children_ptrs) release_schema(child);
+        for(auto* child : array_priv->children_ptrs) release_array(child);
+    };
+
+    try
+    {
+        for(auto const& hdr : headers)
+        {
+            auto const& values = at(hdr);
+            if(static_cast<std::int64_t>(values.size()) != length)
+            {
+                throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: column {} has {} rows instead of {}", hdr, values.size(), length));
+            }
+
+            auto child_schema_priv = std::make_unique<SchemaPrivate>();
+            auto child_array_priv = std::make_unique<ArrayPrivate>();
+            child_schema_priv->name = hdr;
+
+            bool is_numeric = std::find(numeric_hdrs.begin(), numeric_hdrs.end(), hdr) != numeric_hdrs.end();
+            std::int64_t null_count = is_numeric ? export_doubles(values, hdr, null_values, *child_array_priv, *child_schema_priv)
+                                                 : export_strings(values, null_values, *child_array_priv, *child_schema_priv);
+
+            // the child structures are owned by the parent before they own their private data
+            auto* child_schema = schema_priv->children.emplace_back(std::make_unique<ArrowSchema>()).get();
+            auto* child_array = array_priv->children.emplace_back(std::make_unique<ArrowArray>()).get();
+            init_schema(child_schema, child_schema_priv.release());
+            schema_priv->children_ptrs.push_back(child_schema);
+            init_array(child_array, child_array_priv.release(), length, null_count);
+            array_priv->children_ptrs.push_back(child_array);
+        }
+    }
+    catch(...)
+    {
+        release_children();
+        throw;
+    }
+
+    array_priv->buffers = {nullptr};
+    init_schema(schema, schema_priv.release());
+    schema->flags = 0;
+    init_array(array, array_priv.release(), length, 0);
+}
+
+void DF::DataFrame::from_arrow(ArrowArray* array, ArrowSchema* schema, std::string const& null_value)
+{
+    try
+    {
+        import_arrow(array, schema, null_value);
+    }
+    catch(DF::memory_limit_error const&)
+    {
+        fail_load("arrow array");
+    }
+}
+
+void DF::DataFrame::import_arrow(ArrowArray* array, ArrowSchema* schema, std::string const& null_value)
+{
+    ArrowReleaser releaser{array, schema};
+
+    if(array == nullptr || schema == nullptr || array->release == nullptr || schema->release == nullptr)
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: from_arrow needs a valid (not released) ArrowArray and ArrowSchema"));
+    }
+
+    if(std::string_view(schema->format) != "+s" || schema->n_children != array->n_children)
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: from_arrow expects a struct array (format +s), got format {}", schema->format));
+    }
+
+    DF::DataFrame new_df(get_memory_resource());
+    std::int64_t length = array->length;
+
+    for(std::int64_t i_col{0}; i_col < schema->n_children; ++i_col)
+    {
+        ArrowSchema const* child_schema = schema->children[i_col];
+        ArrowArray const* child_array = array->children[i_col];
+        std::string_view format(child_schema->format);
+        std::int64_t first = array->offset + child_array->offset;
+
+        std::shorts::Column values(static_cast<std::size_t>(length), new_df.get_memory_resource());
+
+        if(format == "u") import_strings<std::int32_t>(child_array, first, length, null_value, values);
+        else if(format == "U") import_strings<std::int64_t>(child_array, first, length, null_value, values);
+        else if(format == "g") import_primitive<double>(child_array, first, length, null_value, values);
+        else if(format == "f") import_primitive<float>(child_array, first, length, null_value, values);
+        else if(format == "l") import_primitive<std::int64_t>(child_array, first, length, null_value, values);
+        else if(format == "i") import_primitive<std::int32_t>(child_array, first, length, null_value, values);
+        else if(format == "s") import_primitive<std::int16_t>(child_array, first, length, null_value, values);
+        else if(format == "c") import_primitive<std::int8_t>(child_array, first, length, null_value, values);
+        else if(format == "L") import_primitive<std::uint64_t>(child_array, first, length, null_value, values);
+        else if(format == "I") import_primitive<std::uint32_t>(child_array, first, length, null_value, values);
+        else if(format == "S") import_primitive<std::uint16_t>(child_array, first, length, null_value, values);
+        else if(format == "C") import_primitive<std::uint8_t>(child_array, first, length, null_value, values);
+        else if(format == "b")
+        {
+            auto const* bits = static_cast<std::uint8_t const*>(child_array->buffers[1]);
+            for(std::int64_t i{0}; i < length; ++i)
+            {
+                std::int64_t j = first + i;
+                if(is_valid(child_array, j)) values[i] = (bits[j / 8] >> (j % 8)) & 1 ? "1" : "0";
+                else values[i] = null_value;
+            }
+        }
+        else
+        {
+            throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: unsupported arrow format {} of column {}", format, i_col + 1));
+        }
+
+        std::string hdr = child_schema->name != nullptr && child_schema->name[0] != '\0' ? child_schema->name : std::to_string(i_col + 1);
+        new_df.insert_col(std::move(values), hdr);
+    }
+
+    new_df.n_rows = static_cast<unsigned long long>(length);
+    *this = std::move(new_df);
+}
@@ -0,0 +1,689 @@
+#include <algorithm>
+#include <atomic>
+#include "AsyncReader.hpp"
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fcntl.h>
+#include <iterator>
+#include "fmt/color.h"
+#include "fmt/format.h"
+#include "Parallel.hpp"
+#include <stdexcept>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define DF_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace
+{
+    std::mutex options_mutex;
+    DF::AsyncReadOptions default_options;
+
+    [[noreturn]] void fail_read(std::string_view path)
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: unable to read file {}.\nPlease check your input.", path));
+    }
+
+    /**
+     * @brief a read of one chunk
+     *
+     */
+    struct ChunkRead
+    {
+        std::size_t i_file;
+        std::size_t i_chunk;
+        std::uint64_t offset;
+        std::size_t size;
+        int fd;
+    };
+
+    /**
+     * @brief hands out the chunks of all files in order, a file is opened at its first chunk
+     * and closed when all its chunks were read, so only the files being read are open
+     *
+     */
+    class ChunkDispenser
+    {
+        public:
+            ChunkDispenser(std::vector<std::string> const& paths, std::size_t size)
+                : chunk_size(size)
+            {
+                for(auto const& path : paths)
+                {
+                    struct stat st;
+                    if(::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) fail_read(path);
+
+                    auto file_size = static_cast<std::uint64_t>(st.st_size);
+                    std::size_t n_chunks = static_cast<std::size_t>((file_size + chunk_size - 1) / chunk_size);
+                    files.push_back({path, file_size, n_chunks, -1, n_chunks});
+                }
+            }
+
+            ~ChunkDispenser()
+            {
+                for(auto const& file : files)
+                {
+                    if(file.fd >= 0) ::close(file.fd);
+                }
+            }
+
+            ChunkDispenser(ChunkDispenser const&) = delete;
+            ChunkDispenser& operator=(ChunkDispenser const&) = delete;
+
+            bool next(ChunkRead& read)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                while(i_file < files.size() && i_chunk == files[i_file].n_chunks)
+                {
+                    ++i_file;
+                    i_chunk = 0;
+                }
+                if(i_file == files.size()) return false;
+
+                auto& file = files[i_file];
+                if(file.fd < 0)
+                {
+                    file.fd = ::open(file.path.c_str(), O_RDONLY);
+                    if(file.fd < 0) fail_read(file.path);
+                }
+
+                std::uint64_t offset = static_cast<std::uint64_t>(i_chunk) * chunk_size;
+                read = {i_file, i_chunk, offset, static_cast<std::size_t>(std::min<std::uint64_t>(chunk_size, file.size - offset)), file.fd};
+                ++i_chunk;
+
+                return true;
+            }
+
+            void finish(std::size_t i_read_file)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                auto& file = files[i_read_file];
+                if(--file.n_pending == 0)
+                {
+                    ::close(file.fd);
+                    file.fd = -1;
+                }
+            }
+
+            std::size_t n_chunks(std::size_t i_read_file) const
+            {
+                return files[i_read_file].n_chunks;
+            }
+
+            std::string const& path(std::size_t i_read_file) const
+            {
+                return files[i_read_file].path;
+            }
+
+        private:
+            struct File
+            {
+                std::string path;
+                std::uint64_t size;
+                std::size_t n_chunks;
+                int fd;
+                std::size_t n_pending;
+            };
+
+            std::size_t chunk_size;
+            std::vector<File> files;
+            std::size_t i_file = 0;
+            std::size_t i_chunk = 0;
+            std::mutex mutex;
+    };
+
+    /**
+     * @brief filled buffers waiting for a worker
+     *
+     */
+    class WorkQueue
+    {
+        public:
+            struct Work
+            {
+                DF::ReadChunk chunk;
+                char* buffer;
+            };
+
+            void push(Work work)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    works.push_back(work);
+                }
+                is_changed.notify_one();
+            }
+
+            bool pop(Work& work)
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                is_changed.wait(lock, [this] { return !works.empty() || is_closed; });
+                if(works.empty()) return false;
+
+                work = works.front();
+                works.pop_front();
+                return true;
+            }
+
+            void close()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    is_closed = true;
+                }
+                is_changed.notify_all();
+            }
+
+        private:
+            std::deque<Work> works;
+            bool is_closed = false;
+            std::mutex mutex;
+            std::condition_variable is_changed;
+    };
+
+    void read_fully(int fd, char* buffer, std::size_t size, std::uint64_t offset, std::string const& path)
+    {
+        std::size_t done = 0;
+        while(done < size)
+        {
+            ssize_t n = ::pread(fd, buffer + done, size - done, static_cast<off_t>(offset + done));
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) fail_read(path);
+            done += static_cast<std::size_t>(n);
+        }
+    }
+
+#ifdef DF_HAS_IO_URING
+    /**
+     * @brief minimal io_uring submission and completion rings through the raw system calls
+     *
+     */
+    class IoUring
+    {
+        public:
+            IoUring() = default;
+            IoUring(IoUring const&) = delete;
+            IoUring& operator=(IoUring const&) = delete;
+
+            ~IoUring()
+            {
+                if(sqes != nullptr) ::munmap(sqes, sqes_size);
+                if(cq_ptr != nullptr && cq_ptr != sq_ptr) ::munmap(cq_ptr, cq_size);
+                if(sq_ptr != nullptr) ::munmap(sq_ptr, sq_size);
+                if(ring_fd >= 0) ::close(ring_fd);
+            }
+
+            /**
+             * @brief set up the rings, false if io_uring is not available (old kernel, seccomp, ...)
+             *
+             */
+            bool init(unsigned entries)
+            {
+                io_uring_params params;
+                std::memset(&params, 0, sizeof(params));
+
+                ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+                if(ring_fd < 0) return false;
+
+                sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                bool is_single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if(is_single_mmap) sq_size = cq_size = std::max(sq_size, cq_size);
+
+                sq_ptr = map(sq_size, IORING_OFF_SQ_RING);
+                if(sq_ptr == nullptr) return false;
+                cq_ptr = is_single_mmap ? sq_ptr : map(cq_size, IORING_OFF_CQ_RING);
+                if(cq_ptr == nullptr) return false;
+                sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+                sqes = static_cast<io_uring_sqe*>(map(sqes_size, IORING_OFF_SQES));
+                if(sqes == nullptr) return false;
+
+                auto* sq = static_cast<char*>(sq_ptr);
+                sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+                auto* cq = static_cast<char*>(cq_ptr);
+                cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+                cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+                cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+                cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+                return true;
+            }
+
+            /**
+             * @brief queue a read, iov must stay valid until its completion
+             *
+             */
+            void prepare_read(int fd, iovec* iov, std::uint64_t offset, std::uint64_t user_data)
+            {
+                unsigned tail = *sq_tail;
+                unsigned index = tail & sq_mask;
+
+                io_uring_sqe* sqe = &sqes[index];
+                std::memset(sqe, 0, sizeof(*sqe));
+                sqe->opcode = IORING_OP_READV;
+                sqe->fd = fd;
+                sqe->addr = reinterpret_cast<std::uint64_t>(iov);
+                sqe->len = 1;
+                sqe->off = offset;
+                sqe->user_data = user_data;
+
+                sq_array[index] = index;
+                __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+                ++n_to_submit;
+            }
+
+            /**
+             * @brief submit the queued reads and wait for at least one completion
+             *
+             */
+            void submit_and_wait()
+            {
+                while(true)
+                {
+                    long n = ::syscall(__NR_io_uring_enter, ring_fd, n_to_submit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                    if(n >= 0)
+                    {
+                        n_to_submit -= static_cast<unsigned>(n);
+                        return;
+                    }
+                    if(errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                    {
+                        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: io_uring_enter failed: {}", std::strerror(errno)));
+                    }
+                }
+            }
+
+            /**
+             * @brief call fn(user_data, result) for each completed read
+             *
+             */
+            template<typename Fn>
+            void for_each_completion(Fn&& fn)
+            {
+                unsigned head = *cq_head;
+                unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+                while(head != tail)
+                {
+                    io_uring_cqe const& cqe = cqes[head & cq_mask];
+                    fn(cqe.user_data, cqe.res);
+                    ++head;
+                }
+                __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+            }
+
+        private:
+            int ring_fd = -1;
+            void* sq_ptr = nullptr;
+            void* cq_ptr = nullptr;
+            std::size_t sq_size = 0;
+            std::size_t cq_size = 0;
+            io_uring_sqe* sqes = nullptr;
+            std::size_t sqes_size = 0;
+            unsigned* sq_tail = nullptr;
+            unsigned sq_mask = 0;
+            unsigned* sq_array = nullptr;
+            unsigned* cq_head = nullptr;
+            unsigned* cq_tail = nullptr;
+            unsigned cq_mask = 0;
+            io_uring_cqe* cqes = nullptr;
+            unsigned n_to_submit = 0;
+
+            void* map(std::size_t size, off_t offset)
+            {
+                void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+                return ptr == MAP_FAILED ? nullptr : ptr;
+            }
+    };
+#endif
+
+    /**
+     * @brief lines of a chunk (each one turned into a Row): the text before its first newline (head)
+     * and after its last (tail) belong to lines shared with the neighbouring chunks
+     *
+     */
+    template<typename Row>
+    struct ChunkLines
+    {
+        std::string head;
+        bool has_newline = false;
+        std::vector<Row> lines;
+        std::string tail;
+    };
+
+    template<typename Row, typename MakeRow>
+    void add_line(std::vector<Row>& lines, std::string_view line, MakeRow const& make_row)
+    {
+        if(line.empty()) return;
+        std::string cell(line);
+        cell.erase(std::remove(cell.begin(), cell.end(), '\r'), cell.end());
+        lines.push_back(make_row(std::move(cell)));
+    }
+
+    /**
+     * @brief read files with AsyncReader and turn each non-empty line into a Row,
+     * the lines inside a chunk are handled by the worker which received the chunk
+     *
+     */
+    template<typename Row, typename MakeRow>
+    std::vector<std::vector<Row>> read_async(std::vector<std::string> const& paths, DF::AsyncReadOptions const& options, MakeRow const& make_row)
+    {
+        std::vector<std::vector<ChunkLines<Row>>> parts(paths.size());
+        std::mutex parts_mutex;
+
+        DF::AsyncReader reader(options);
+        reader.read(paths, [&](DF::ReadChunk const& chunk)
+        {
+            {
+                std::lock_guard<std::mutex> lock(parts_mutex);
+                if(parts[chunk.i_file].empty()) parts[chunk.i_file].resize(chunk.n_chunks);
+            }
+            auto& part = parts[chunk.i_file][chunk.i_chunk];
+            std::string_view data = chunk.data;
+
+            std::size_t first = data.find('\n');
+            if(first == std::string_view::npos)
+            {
+                part.head.assign(data);
+                return;
+            }
+
+            std::size_t last = data.rfind('\n');
+            part.has_newline = true;
+            part.head.assign(data.substr(0, first));
+            part.tail.assign(data.substr(last + 1));
+
+            for(std::size_t pos{first + 1}; pos <= last;)
+            {
+                std::size_t end = data.find('\n', pos);
+                add_line(part.lines, data.substr(pos, end - pos), make_row);
+                pos = end + 1;
+            }
+        });
+
+        // stitch the lines shared by neighbouring chunks, in file order
+        std::vector<std::vector<Row>> vv_lines(paths.size());
+        DF::parallel_tasks(paths.size(), [&](std::size_t i_file)
+        {
+            auto& lines = vv_lines[i_file];
+            std::size_t n_lines = 0;
+            for(auto const& part : parts[i_file]) n_lines += part.lines.size() + 1;
+            lines.reserve(n_lines);
+
+            std::string carry;
+            for(auto& part : parts[i_file])
+            {
+                carry += part.head;
+                if(!part.has_newline) continue;
+
+                add_line(lines, carry, make_row);
+                std::move(part.lines.begin(), part.lines.end(), std::back_inserter(lines));
+                carry = std::move(part.tail);
+            }
+            add_line(lines, carry, make_row);
+        });
+
+        return vv_lines;
+    }
+}
+
+void DF::set_async_read_options(AsyncReadOptions const& options)
+{
+    std::lock_guard<std::mutex> lock(options_mutex);
+    default_options = options;
+}
+
+DF::AsyncReadOptions DF::get_async_read_options()
+{
+    std::lock_guard<std::mutex> lock(options_mutex);
+    return default_options;
+}
+
+DF::BufferPool::BufferPool(std::size_t n_buffers, std::size_t buffer_size)
+    : memory(new char[n_buffers * buffer_size])
+{
+    for(std::size_t i{0}; i < n_buffers; ++i) free_buffers.push_back(memory.get() + i * buffer_size);
+}
+
+char* DF::BufferPool::acquire()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    is_released.wait(lock, [this] { return !free_buffers.empty(); });
+
+    char* buffer = free_buffers.back();
+    free_buffers.pop_back();
+    return buffer;
+}
+
+char* DF::BufferPool::try_acquire()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if(free_buffers.empty()) return nullptr;
+
+    char* buffer = free_buffers.back();
+    free_buffers.pop_back();
+    return buffer;
+}
+
+void DF::BufferPool::release(char* buffer)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        free_buffers.push_back(buffer);
+    }
+    is_released.notify_one();
+}
+
+DF::AsyncReader::AsyncReader(AsyncReadOptions read_options)
+    : options(read_options)
+{
+    options.queue_depth = std::clamp<std::size_t>(options.queue_depth, 1, 4096);
+    options.buffer_size = std::max<std::size_t>(options.buffer_size, 4096);
+    if(options.n_workers == 0) options.n_workers = DF::default_n_threads();
+}
+
+bool DF::AsyncReader::uses_io_uring() const
+{
+    return is_io_uring;
+}
+
+void DF::AsyncReader::read(std::vector<std::string> const& paths, Consumer const& consumer)
+{
+    ChunkDispenser dispenser(paths, options.buffer_size);
+    BufferPool pool(options.queue_depth + options.n_workers, options.buffer_size);
+    WorkQueue queue;
+
+    std::atomic<bool> is_failed{false};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto fail = [&](std::exception_ptr e)
+    {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if(!error) error = e;
+        is_failed = true;
+    };
+
+    // after an error the workers only return the buffers to the pool
+    std::vector<std::thread> v_workers;
+    for(std::size_t i{0}; i < options.n_workers; ++i)
+    {
+        v_workers.emplace_back([&]()
+        {
+            WorkQueue::Work work;
+            while(queue.pop(work))
+            {
+                if(!is_failed)
+                {
+                    try
+                    {
+                        consumer(work.chunk);
+                    }
+                    catch(...)
+                    {
+                        fail(std::current_exception());
+                    }
+                }
+                pool.release(work.buffer);
+            }
+        });
+    }
+
+    auto hand_over = [&](ChunkRead const& read, char* buffer)
+    {
+        dispenser.finish(read.i_file);
+        queue.push({{read.i_file, read.i_chunk, dispenser.n_chunks(read.i_file), read.offset, std::string_view(buffer, read.size)}, buffer});
+    };
+
+    is_io_uring = false;
+    try
+    {
+#ifdef DF_HAS_IO_URING
+        IoUring ring;
+        if(options.use_io_uring && ring.init(static_cast<unsigned>(options.queue_depth)))
+        {
+            is_io_uring = true;
+
+            struct Slot
+            {
+                ChunkRead read;
+                char* buffer;
+                std::size_t done;
+                iovec iov;
+            };
+            std::vector<Slot> slots(options.queue_depth);
+            std::vector<std::size_t> free_slots;
+            for(std::size_t i{slots.size()}; i > 0; --i) free_slots.push_back(i - 1);
+
+            auto submit = [&](std::size_t i_slot)
+            {
+                auto& slot = slots[i_slot];
+                slot.iov.iov_base = slot.buffer + slot.done;
+                slot.iov.iov_len = slot.read.size - slot.done;
+                ring.prepare_read(slot.read.fd, &slot.iov, slot.read.offset + slot.done, i_slot);
+            };
+
+            // keep queue_depth reads in flight, the ring is left only when no read is in flight
+            bool has_more = true;
+            while(true)
+            {
+                while(has_more && !is_failed && !free_slots.empty())
+                {
+                    bool is_idle = free_slots.size() == slots.size();
+                    char* buffer = is_idle ? pool.acquire() : pool.try_acquire();
+                    if(buffer == nullptr) break;
+
+                    ChunkRead read;
+                    try
+                    {
+                        has_more = dispenser.next(read);
+                    }
+                    catch(...)
+                    {
+                        pool.release(buffer);
+                        fail(std::current_exception());
+                        break;
+                    }
+                    if(!has_more)
+                    {
+                        pool.release(buffer);
+                        break;
+                    }
+
+                    std::size_t i_slot = free_slots.back();
+                    free_slots.pop_back();
+                    slots[i_slot] = {read, buffer, 0, {}};
+                    submit(i_slot);
+                }
+
+                if(free_slots.size() == slots.size()) break;
+
+                ring.submit_and_wait();
+                ring.for_each_completion([&](std::uint64_t i_slot, int result)
+                {
+                    auto& slot = slots[i_slot];
+                    if(result <= 0)
+                    {
+                        fail(std::make_exception_ptr(std::runtime_error(fmt::format(fg(fmt::color::red),
+                            "Error: unable to read file {}.\nPlease check your input.", dispenser.path(slot.read.i_file)))));
+                    }
+                    else
+                    {
+                        slot.done += static_cast<std::size_t>(result);
+                    }
+
+                    if(result > 0 && slot.done < slot.read.size && !is_failed)
+                    {
+                        // short read: ask for the rest
+                        submit(i_slot);
+                        return;
+                    }
+
+                    if(result > 0 && slot.done == slot.read.size) hand_over(slot.read, slot.buffer);
+                    else pool.release(slot.buffer);
+                    free_slots.push_back(i_slot);
+                });
+            }
+        }
+        else
+#endif
+        {
+            // blocking reads from queue_depth threads
+            DF::parallel_tasks(options.queue_depth, [&](std::size_t)
+            {
+                while(!is_failed)
+                {
+                    char* buffer = pool.acquire();
+                    ChunkRead read;
+                    try
+                    {
+                        if(!dispenser.next(read))
+                        {
+                            pool.release(buffer);
+                            return;
+                        }
+                        read_fully(read.fd, buffer, read.size, read.offset, dispenser.path(read.i_file));
+                    }
+                    catch(...)
+                    {
+                        pool.release(buffer);
+                        fail(std::current_exception());
+                        return;
+                    }
+                    hand_over(read, buffer);
+                }
+            }, options.queue_depth);
+        }
+    }
+    catch(...)
+    {
+        fail(std::current_exception());
+    }
+
+    queue.close();
+    for(auto& worker : v_workers) worker.join();
+
+    if(error) std::rethrow_exception(error);
+}
+
+std::vector<std::vector<std::string>> DF::read_lines_async(std::vector<std::string> const& paths, AsyncReadOptions const& options)
+{
+    return read_async<std::string>(paths, options, [](std::string&& line) { return std::move(line); });
+}
+
+std::vector<std::vector<std::vector<std::string>>> DF::read_rows_async(std::vector<std::string> const& paths, LineParser const& parse, AsyncReadOptions const& options)
+{
+    return read_async<std::vector<std::string>>(paths, options, [&](std::string&& line) { return parse(line); });
+}
@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <cmath>
+#include "Follow.hpp"
+#include <fstream>
+#include "ReadFiles.hpp"
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace
+{
+    // number of bytes at the start of a followed file compared at each refresh
+    constexpr std::size_t follow_prefix_size = 64;
+}
+
+void DF::RunningStats::add(double value)
+{
+    if(std::isnan(value)) return;
+
+    ++count;
+    sum += value;
+    min = std::min(min, value);
+    max = std::max(max, value);
+}
+
+double DF::RunningStats::mean() const
+{
+    return count == 0 ? std::numeric_limits<double>::quiet_NaN() : sum / static_cast<double>(count);
+}
+
+DF::RunningAggregate::RunningAggregate(std::string group, std::string value)
+    : group_hdr(std::move(group)), value_hdr(std::move(value))
+{
+}
+
+void DF::RunningAggregate::add(std::string_view group, double value)
+{
+    if(group_hdr.empty()) group = {};
+
+    auto it = group_pos.find(std::string(group));
+    if(it == group_pos.end())
+    {
+        it = group_pos.emplace(std::string(group), groups.size()).first;
+        groups.emplace_back(group);
+        stats.emplace_back();
+    }
+
+    stats[it->second].add(value);
+}
+
+void DF::RunningAggregate::clear()
+{
+    groups.clear();
+    stats.clear();
+    group_pos.clear();
+}
+
+void DF::DataFrame::update_aggregates(std::size_t first_row)
+{
+    // convert the new values of all aggregates before changing any of them
+    std::vector<std::vector<double>> vv_values;
+    for(auto const& aggregate : aggregates)
+    {
+        auto const& values = at(aggregate.value_hdr);
+        std::vector<double> v_values;
+        v_values.reserve(values.size() - std::min(first_row, values.size()));
+        for(std::size_t i_row{first_row}; i_row < values.size(); ++i_row)
+        {
+            v_values.push_back(DF::parse_cell<double>(values[i_row], aggregate.value_hdr, i_row));
+        }
+        vv_values.push_back(std::move(v_values));
+    }
+
+    for(std::size_t i_agg{0}; i_agg < aggregates.size(); ++i_agg)
+    {
+        auto& aggregate = aggregates[i_agg];
+        auto const* groups = aggregate.group_hdr.empty() ? nullptr : &at(aggregate.group_hdr);
+        for(std::size_t i{0}; i < vv_values[i_agg].size(); ++i)
+        {
+            std::string_view group = groups == nullptr ? std::string_view{} : std::string_view((*groups)[first_row + i]);
+            aggregate.add(group, vv_values[i_agg][i]);
+        }
+    }
+}
+
+void DF::DataFrame::track_aggregate(std::string const& value_hdr, std::string const& group_hdr)
+{
+    at(value_hdr);
+    if(!group_hdr.empty()) at(group_hdr);
+
+    for(auto const& aggregate : aggregates)
+    {
+        if(aggregate.value_hdr == value_hdr && aggregate.group_hdr == group_hdr) return;
+    }
+
+    // aggregate the current rows once, later rows are added incrementally
+    std::vector<RunningAggregate> tracked;
+    tracked.swap(aggregates);
+    aggregates.emplace_back(group_hdr, value_hdr);
+    try
+    {
+        update_aggregates(0);
+    }
+    catch(...)
+    {
+        aggregates.swap(tracked);
+        throw;
+    }
+    tracked.push_back(std::move(aggregates.back()));
+    aggregates.swap(tracked);
+}
+
+DF::DataFrame DF::DataFrame::get_aggregate(std::string const& value_hdr, std::string const& group_hdr) const
+{
+    auto it = std::find_if(aggregates.begin(), aggregates.end(), [&](auto const& aggregate)
+    {
+        return aggregate.value_hdr == value_hdr && aggregate.group_hdr == group_hdr;
+    });
+
+    if(it == aggregates.end())
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: no aggregate of {} by \"{}\" is tracked, call track_aggregate first", value_hdr, group_hdr));
+    }
+
+    std::shorts::V_string v_count, v_sum, v_mean, v_min, v_max;
+    for(auto const& stats : it->stats)
+    {
+        v_count.push_back(std::to_string(stats.count));
+        v_sum.push_back(DF::to_cell(stats.sum));
+        v_mean.push_back(DF::to_cell(stats.mean()));
+        v_min.push_back(stats.count == 0 ? "NA" : DF::to_cell(stats.min));
+        v_max.push_back(stats.count == 0 ? "NA" : DF::to_cell(stats.max));
+    }
+
+    DF::DataFrame result;
+    if(!group_hdr.empty())
+    {
+        result.add_col(it->groups, group_hdr);
+    }
+    result.add_col(std::move(v_count), "count");
+    result.add_col(std::move(v_sum), "sum");
+    result.add_col(std::move(v_mean), "mean");
+    result.add_col(std::move(v_min), "min");
+    result.add_col(std::move(v_max), "max");
+    result.n_rows = it->stats.size();
+
+    return result;
+}
+
+void DF::DataFrame::follow(std::string_view path, char delim, bool is_first_col_header, std::shorts::V_string v_hdrs)
+{
+    // registered aggregates are kept and recomputed from the new rows
+    std::vector<RunningAggregate> tracked;
+    tracked.swap(aggregates);
+    for(auto& aggregate : tracked) aggregate.clear();
+
+    clear();
+    n_rows = 0;
+    n_cols = 0;
+    follow_state = FollowState{};
+    follow_state.is_active = true;
+    follow_state.path = std::string(path);
+    follow_state.delim = delim;
+    follow_state.is_first_col_header = is_first_col_header;
+    follow_state.v_hdrs = std::move(v_hdrs);
+    aggregates.swap(tracked);
+
+    refresh();
+}
+
+std::size_t DF::DataFrame::refresh()
+{
+    if(!follow_state.is_active)
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: the data frame does not follow a file, call follow first"));
+    }
+
+    std::ifstream ifs(follow_state.path, std::ios::binary);
+    if(ifs.fail())
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: unable to read file {}.\nPlease check your input.", follow_state.path));
+    }
+
+    ifs.seekg(0, std::ios::end);
+    auto size = static_cast<std::uint64_t>(ifs.tellg());
+
+    struct stat file_stat{};
+    bool has_file_id = ::stat(follow_state.path.c_str(), &file_stat) == 0;
+    bool is_replaced = size < follow_state.offset;
+    if(has_file_id && follow_state.has_file_id)
+    {
+        is_replaced = is_replaced || static_cast<std::uint64_t>(file_stat.st_dev) != follow_state.device
+                                  || static_cast<std::uint64_t>(file_stat.st_ino) != follow_state.inode;
+    }
+    if(!is_replaced && !follow_state.prefix.empty())
+    {
+        std::string prefix(follow_state.prefix.size(), '\0');
+        ifs.seekg(0);
+        ifs.read(prefix.data(), static_cast<std::streamsize>(prefix.size()));
+        is_replaced = !ifs || prefix != follow_state.prefix;
+        ifs.clear();
+    }
+
+    if(is_replaced)
+    {
+        // the file was truncated, replaced or rewritten, start again
+        FollowState state = follow_state;
+        follow(state.path, state.delim, state.is_first_col_header, state.v_hdrs);
+        return headers.empty() ? 0 : at(headers[0]).size();
+    }
+
+    if(has_file_id && !follow_state.has_file_id)
+    {
+        follow_state.has_file_id = true;
+        follow_state.device = static_cast<std::uint64_t>(file_stat.st_dev);
+        follow_state.inode = static_cast<std::uint64_t>(file_stat.st_ino);
+    }
+
+    if(size == follow_state.offset) return 0;
+
+    std::string buffer(size - follow_state.offset, '\0');
+    ifs.seekg(static_cast<std::streamoff>(follow_state.offset));
+    ifs.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+    // only complete lines are parsed, the rest is read again by the next refresh
+    std::size_t n_complete = buffer.rfind('\n');
+    if(n_complete == std::string::npos) return 0;
+    ++n_complete;
+
+    std::shorts::VV_string vv_strs;
+    std::shorts::V_string v_new_hdrs;
+    bool has_schema = !headers.empty();
+    std::size_t line_start = 0;
+    while(line_start < n_complete)
+    {
+        std::size_t line_end = buffer.find('\n', line_start);
+        std::string line = buffer.substr(line_start, line_end - line_start);
+        line_start = line_end + 1;
+
+        line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+        if(line.empty()) continue;
+
+        auto cells = follow_state.delim == ' ' ? parse_line_whitespace(line) : parse_line(line, follow_state.delim);
+
+        if(!has_schema)
+        {
+            // first line of the file: set up the schema
+            has_schema = true;
+            if(follow_state.is_first_col_header)
+            {
+                v_new_hdrs = cells;
+                continue;
+            }
+            else if(!follow_state.v_hdrs.empty())
+            {
+                if(follow_state.v_hdrs.size() != cells.size())
+                {
+                    throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: number of provided headers does not match with the number of columns in the data"));
+                }
+                v_new_hdrs = follow_state.v_hdrs;
+            }
+            else
+            {
+                for(std::size_t i_col{0}; i_col < cells.size(); ++i_col) v_new_hdrs.push_back(std::to_string(i_col + 1));
+            }
+        }
+
+        std::size_t n_expected = headers.empty() ? v_new_hdrs.size() : headers.size();
+        if(cells.size() != n_expected)
+        {
+            throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: inconsistent number of columns in {}, check the line ending at byte {}",
+                                                 follow_state.path, follow_state.offset + line_start));
+        }
+
+        vv_strs.push_back(std::move(cells));
+    }
+
+    std::size_t n_old_cols = headers.size();
+    std::size_t n_old_rows = headers.empty() ? 0 : at(headers[0]).size();
+    std::vector<std::shorts::Column*> v_cols;
+
+    try
+    {
+        for(auto const& hdr : v_new_hdrs)
+        {
+            insert_col(std::shorts::Column(get_memory_resource()), hdr);
+        }
+
+        for(auto const& hdr : headers) v_cols.push_back(&data[hdr]);
+        // grow geometrically, an exact reserve would copy all rows on every refresh
+        for(auto* col : v_cols)
+        {
+            std::size_t needed = n_old_rows + vv_strs.size();
+            if(needed > col->capacity()) col->reserve(std::max(2 * col->capacity(), needed));
+        }
+        for(auto const& cells : vv_strs)
+        {
+            for(std::size_t i_col{0}; i_col < v_cols.size(); ++i_col)
+            {
+                v_cols[i_col]->emplace_back(cells[i_col]);
+            }
+        }
+
+        update_aggregates(n_old_rows);
+    }
+    catch(...)
+    {
+        // leave the data frame as it was before the refresh, without the columns of a failed first refresh
+        for(auto* col : v_cols) col->resize(n_old_rows);
+        for(std::size_t i_col{n_old_cols}; i_col < headers.size(); ++i_col) data.erase(headers[i_col]);
+        headers.resize(n_old_cols);
+        n_cols = n_old_cols;
+        throw;
+    }
+
+    // remember the first bytes of the file to detect when it is rewritten in place
+    if(follow_state.prefix.size() < follow_prefix_size)
+    {
+        std::size_t n_prefix = std::min<std::uint64_t>(follow_state.offset + n_complete, follow_prefix_size) - follow_state.prefix.size();
+        follow_state.prefix.append(buffer, 0, n_prefix);
+    }
+
+    follow_state.offset += n_complete;
+    n_rows = n_old_rows + vv_strs.size();
+    n_cols = headers.size();
+
+    if(!index.empty() && !index.is_stale)
+    {
+        index.extend(index_cols(), n_old_rows);
+    }
+
+    return vv_strs.size();
+}
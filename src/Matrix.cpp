@@ -0,0 +1,109 @@
+#include "fmt/color.h"
+#include "fmt/format.h"
+#include "Matrix.hpp"
+#include "Parallel.hpp"
+#include "ReadFiles.hpp"
+#include <stdexcept>
+
+DF::Matrix::Matrix(std::size_t rows, std::size_t cols, Layout layout)
+    : n_rows(rows), n_cols(cols), cell_layout(layout)
+{
+    if(rows * cols > 0)
+    {
+        values.reset(static_cast<double*>(::operator new[](rows * cols * sizeof(double), std::align_val_t(matrix_alignment))));
+    }
+}
+
+void DF::DataFrame::to_matrix(std::shorts::V_string const& hdrs, double* out, Layout layout) const
+{
+    std::vector<std::shorts::Column const*> v_cols;
+    for(auto const& hdr : hdrs) v_cols.push_back(&at(hdr));
+
+    std::size_t n = v_cols.empty() ? 0 : v_cols[0]->size();
+    std::size_t k = v_cols.size();
+    for(std::size_t i_col{1}; i_col < k; ++i_col)
+    {
+        if(v_cols[i_col]->size() != n)
+        {
+            throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: column {} has {} rows but column {} has {}", hdrs[i_col], v_cols[i_col]->size(), hdrs[0], n));
+        }
+    }
+
+    // each thread parses a contiguous block of rows straight into the output
+    DF::parallel_for(n, [&](std::size_t begin, std::size_t end)
+    {
+        if(layout == Layout::row_major)
+        {
+            for(std::size_t i_row{begin}; i_row < end; ++i_row)
+            {
+                for(std::size_t i_col{0}; i_col < k; ++i_col)
+                {
+                    out[i_row * k + i_col] = DF::parse_cell<double>((*v_cols[i_col])[i_row], hdrs[i_col], i_row);
+                }
+            }
+        }
+        else
+        {
+            for(std::size_t i_col{0}; i_col < k; ++i_col)
+            {
+                auto const& values = *v_cols[i_col];
+                double* col_out = out + i_col * n;
+                for(std::size_t i_row{begin}; i_row < end; ++i_row)
+                {
+                    col_out[i_row] = DF::parse_cell<double>(values[i_row], hdrs[i_col], i_row);
+                }
+            }
+        }
+    });
+}
+
+DF::Matrix DF::DataFrame::to_matrix(std::shorts::V_string const& hdrs, Layout layout) const
+{
+    std::size_t n = hdrs.empty() ? 0 : at(hdrs[0]).size();
+    DF::Matrix matrix(n, hdrs.size(), layout);
+    to_matrix(hdrs, matrix.data(), layout);
+
+    return matrix;
+}
+
+void DF::DataFrame::from_matrix(double const* values, std::size_t rows, std::size_t cols, std::shorts::V_string const& hdrs, Layout layout)
+{
+    if(!hdrs.empty() && hdrs.size() != cols)
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: number of provided headers does not match with the number of columns of the matrix"));
+    }
+
+    try
+    {
+        DF::DataFrame new_df(get_memory_resource());
+
+        // the cells are allocated by the worker threads, on one thread if the resource is not thread-safe
+        std::size_t n_threads = DF::is_thread_safe(new_df.get_memory_resource()) ? 0 : 1;
+        for(std::size_t i_col{0}; i_col < cols; ++i_col)
+        {
+            std::shorts::Column cells(rows, new_df.get_memory_resource());
+            DF::parallel_for(rows, [&](std::size_t begin, std::size_t end)
+            {
+                for(std::size_t i_row{begin}; i_row < end; ++i_row)
+                {
+                    double value = layout == Layout::row_major ? values[i_row * cols + i_col] : values[i_col * rows + i_row];
+                    cells[i_row] = DF::to_cell(value);
+                }
+            }, 1 << 14, n_threads);
+
+            new_df.insert_col(std::move(cells), hdrs.empty() ? std::to_string(i_col + 1) : hdrs[i_col]);
+        }
+
+        new_df.n_rows = rows;
+        *this = std::move(new_df);
+    }
+    catch(DF::memory_limit_error const&)
+    {
+        fail_load("matrix");
+    }
+}
+
+void DF::DataFrame::from_matrix(Matrix const& matrix, std::shorts::V_string const& hdrs)
+{
+    from_matrix(matrix.data(), matrix.rows(), matrix.cols(), hdrs, matrix.layout());
+}
@@ -0,0 +1,113 @@
+#include "Memory.hpp"
+
+namespace
+{
+    std::atomic<std::size_t> memory_limit{0};
+    std::atomic<std::size_t> total_bytes{0};
+
+    // add bytes to the total, or throw if the total would exceed the limit
+    void charge(std::size_t bytes)
+    {
+        std::size_t limit = memory_limit.load(std::memory_order_relaxed);
+        std::size_t total = total_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+        if(limit > 0 && total > limit)
+        {
+            total_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+            throw DF::memory_limit_error();
+        }
+    }
+}
+
+DF::TrackingResource::TrackingResource(std::pmr::memory_resource* upstream_resource)
+    : upstream(upstream_resource)
+{
+}
+
+std::size_t DF::TrackingResource::allocated_bytes() const
+{
+    return n_bytes.load(std::memory_order_relaxed);
+}
+
+void* DF::TrackingResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    charge(bytes);
+
+    void* ptr = nullptr;
+    try
+    {
+        ptr = upstream->allocate(bytes, alignment);
+    }
+    catch(...)
+    {
+        total_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        throw;
+    }
+
+    n_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    return ptr;
+}
+
+void DF::TrackingResource::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+{
+    upstream->deallocate(ptr, bytes, alignment);
+    n_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    total_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+std::pmr::memory_resource* DF::TrackingResource::upstream_resource() const
+{
+    return upstream;
+}
+
+bool DF::TrackingResource::do_is_equal(std::pmr::memory_resource const& other) const noexcept
+{
+    return this == &other;
+}
+
+DF::TrackingResource* DF::default_resource()
+{
+    // never destroyed, so data frames with static storage can still free their memory at exit
+    static TrackingResource* resource = new TrackingResource();
+    return resource;
+}
+
+bool DF::is_thread_safe(std::pmr::memory_resource const* mr)
+{
+    if(mr == std::pmr::new_delete_resource()) return true;
+    if(dynamic_cast<std::pmr::synchronized_pool_resource const*>(mr) != nullptr) return true;
+
+    auto const* tracking = dynamic_cast<DF::TrackingResource const*>(mr);
+    return tracking != nullptr && is_thread_safe(tracking->upstream_resource());
+}
+
+void DF::set_memory_limit(std::size_t bytes)
+{
+    memory_limit.store(bytes, std::memory_order_relaxed);
+}
+
+std::size_t DF::get_memory_limit()
+{
+    return memory_limit.load(std::memory_order_relaxed);
+}
+
+std::size_t DF::allocated_bytes()
+{
+    return total_bytes.load(std::memory_order_relaxed);
+}
+
+DF::MemoryReservation::~MemoryReservation()
+{
+    total_bytes.fetch_sub(n_bytes, std::memory_order_relaxed);
+}
+
+void DF::MemoryReservation::add(std::size_t bytes)
+{
+    charge(bytes);
+    n_bytes += bytes;
+}
+
+std::size_t DF::MemoryReservation::reserved_bytes() const
+{
+    return n_bytes;
+}
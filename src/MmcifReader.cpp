@@ -0,0 +1,435 @@
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include "fmt/color.h"
+#include "fmt/format.h"
+#include "MmcifReader.hpp"
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_set>
+#include <utility>
+
+namespace
+{
+    /**
+     * @brief read-only memory mapping of a whole file
+     *
+     */
+    class MappedFile
+    {
+        public:
+            explicit MappedFile(std::string_view path)
+            {
+                std::string path_str(path);
+                int fd = ::open(path_str.c_str(), O_RDONLY);
+                if(fd < 0)
+                {
+                    throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: unable to read file {}.\nPlease check your input.", path));
+                }
+
+                struct stat st;
+                if(::fstat(fd, &st) == 0 && st.st_size > 0)
+                {
+                    size = static_cast<std::size_t>(st.st_size);
+                    void* ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if(ptr != MAP_FAILED)
+                    {
+                        ::madvise(ptr, size, MADV_SEQUENTIAL);
+                        addr = static_cast<char const*>(ptr);
+                    }
+                }
+                ::close(fd);
+
+                if(size > 0 && addr == nullptr)
+                {
+                    throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: unable to map file {} into memory", path));
+                }
+            }
+
+            ~MappedFile()
+            {
+                if(addr != nullptr) ::munmap(const_cast<char*>(addr), size);
+            }
+
+            MappedFile(MappedFile const&) = delete;
+            MappedFile& operator=(MappedFile const&) = delete;
+
+            std::string_view view() const
+            {
+                return addr == nullptr ? std::string_view{} : std::string_view(addr, size);
+            }
+
+        private:
+            char const* addr = nullptr;
+            std::size_t size = 0;
+    };
+
+    struct Token
+    {
+        std::string_view text;
+        // quoted strings and text fields are always values, even if they look like a tag or keyword
+        bool is_quoted = false;
+        std::size_t begin = 0;
+    };
+
+    bool is_space(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    bool starts_with(std::string_view text, std::string_view prefix)
+    {
+        return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    bool is_keyword(std::string_view text, std::string_view keyword)
+    {
+        if(text.size() < keyword.size()) return false;
+        for(std::size_t i{0}; i < keyword.size(); ++i)
+        {
+            char c = text[i];
+            if(c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+            if(c != keyword[i]) return false;
+        }
+        return true;
+    }
+
+    // a bare token which ends the values of a loop
+    bool is_reserved(Token const& token)
+    {
+        return !token.is_quoted &&
+               (starts_with(token.text, "_") || is_keyword(token.text, "loop_") || is_keyword(token.text, "data_") ||
+                is_keyword(token.text, "save_") || is_keyword(token.text, "global_") || is_keyword(token.text, "stop_"));
+    }
+
+    /**
+     * @brief splits a mmCIF buffer into tokens following the CIF 1.1 rules
+     *
+     */
+    class CifTokenizer
+    {
+        public:
+            explicit CifTokenizer(std::string_view buffer) : buf(buffer) {}
+
+            bool next(Token& token)
+            {
+                if(has_peeked)
+                {
+                    has_peeked = false;
+                    token = peeked;
+                    return true;
+                }
+                return read(token);
+            }
+
+            bool peek(Token& token)
+            {
+                if(!has_peeked)
+                {
+                    has_peeked = read(peeked);
+                    if(!has_peeked) return false;
+                }
+                token = peeked;
+                return true;
+            }
+
+            /**
+             * @brief skip the values of a loop starting at position from, line by line,
+             * stops at the first line starting with a tag or a keyword outside of a text field
+             *
+             */
+            void skip_values(std::size_t from)
+            {
+                has_peeked = false;
+                pos = from;
+                if(!at_line_start(pos)) pos = next_line(pos);
+
+                bool in_text = false;
+                while(pos < buf.size())
+                {
+                    if(buf[pos] == ';')
+                    {
+                        in_text = !in_text;
+                    }
+                    else if(!in_text)
+                    {
+                        std::size_t first = pos;
+                        while(first < buf.size() && (buf[first] == ' ' || buf[first] == '\t')) ++first;
+
+                        std::string_view rest = buf.substr(first, 8);
+                        Token candidate{rest, false, first};
+                        if(first < buf.size() && is_reserved(candidate))
+                        {
+                            pos = first;
+                            return;
+                        }
+                    }
+                    pos = next_line(pos);
+                }
+            }
+
+            std::size_t line_of(std::size_t p) const
+            {
+                return static_cast<std::size_t>(std::count(buf.begin(), buf.begin() + std::min(p, buf.size()), '\n')) + 1;
+            }
+
+        private:
+            std::string_view buf;
+            std::size_t pos = 0;
+            Token peeked;
+            bool has_peeked = false;
+
+            bool at_line_start(std::size_t p) const
+            {
+                return p == 0 || buf[p - 1] == '\n';
+            }
+
+            std::size_t next_line(std::size_t p) const
+            {
+                auto const* eol = static_cast<char const*>(std::memchr(buf.data() + p, '\n', buf.size() - p));
+                return eol == nullptr ? buf.size() : static_cast<std::size_t>(eol - buf.data()) + 1;
+            }
+
+            bool read(Token& token)
+            {
+                // skip whitespace and comments
+                while(pos < buf.size())
+                {
+                    char c = buf[pos];
+                    if(is_space(c))
+                    {
+                        ++pos;
+                    }
+                    else if(c == '#')
+                    {
+                        pos = next_line(pos);
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+
+                if(pos >= buf.size()) return false;
+
+                token.begin = pos;
+                char c = buf[pos];
+
+                if(c == ';' && at_line_start(pos))
+                {
+                    // text field: everything up to a line starting with ';'
+                    std::size_t end = buf.find("\n;", pos);
+                    if(end == std::string_view::npos)
+                    {
+                        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: unterminated text field starting at line {}", line_of(pos)));
+                    }
+
+                    std::size_t length = end - pos - 1;
+                    if(length > 0 && buf[pos + length] == '\r') --length;
+                    token.text = buf.substr(pos + 1, length);
+                    token.is_quoted = true;
+                    pos = end + 2;
+                }
+                else if(c == '\'' || c == '"')
+                {
+                    // a quote only closes the value if it is followed by whitespace, e.g. 'O5'' is not closed by the inner quote
+                    std::size_t eol = next_line(pos);
+                    std::size_t close = pos + 1;
+                    while(true)
+                    {
+                        close = buf.find(c, close);
+                        if(close == std::string_view::npos || close >= eol)
+                        {
+                            throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: unterminated quoted value at line {}", line_of(pos)));
+                        }
+                        if(close + 1 == buf.size() || is_space(buf[close + 1])) break;
+                        ++close;
+                    }
+
+                    token.text = buf.substr(pos + 1, close - pos - 1);
+                    token.is_quoted = true;
+                    pos = close + 1;
+                }
+                else
+                {
+                    std::size_t end = pos;
+                    while(end < buf.size() && !is_space(buf[end])) ++end;
+                    token.text = buf.substr(pos, end - pos);
+                    token.is_quoted = false;
+                    pos = end;
+                }
+
+                return true;
+            }
+    };
+
+    /**
+     * @brief columns of one category while the block is parsed
+     *
+     */
+    struct CategoryBuilder
+    {
+        DF::DataFrame df;
+        std::vector<std::shorts::Column*> cols;
+
+        // cells are appended directly to the columns of the data frame
+        void add_item(std::string_view item)
+        {
+            df.add_col(std::shorts::V_string{}, std::string(item));
+            cols.push_back(&df[df.get_headers().back()]);
+        }
+    };
+
+    // split "_atom_site.Cartn_x" into "_atom_site" and "Cartn_x"
+    std::pair<std::string_view, std::string_view> split_tag(std::string_view tag)
+    {
+        std::size_t dot = tag.find('.');
+        if(dot == std::string_view::npos) return {tag, tag.substr(1)};
+        return {tag.substr(0, dot), tag.substr(dot + 1)};
+    }
+
+    void finish_block(std::vector<DF::CifBlock>& v_blocks, std::unordered_map<std::string, CategoryBuilder>& builders)
+    {
+        if(v_blocks.empty()) return;
+
+        for(auto& [category, builder] : builders)
+        {
+            builder.df.n_rows = builder.cols.empty() ? 0 : builder.cols[0]->size();
+            v_blocks.back().categories[category] = std::move(builder.df);
+        }
+
+        builders.clear();
+    }
+}
+
+std::vector<DF::CifBlock> DF::read_mmcif_text(std::string_view text, std::shorts::V_string const& categories)
+{
+    std::unordered_set<std::string> requested;
+    for(auto const& category : categories)
+    {
+        requested.insert(category.empty() || category[0] == '_' ? category : "_" + category);
+    }
+    auto is_requested = [&requested](std::string_view category)
+    {
+        return requested.empty() || requested.count(std::string(category)) > 0;
+    };
+
+    std::vector<DF::CifBlock> v_blocks;
+    std::unordered_map<std::string, CategoryBuilder> builders;
+    CifTokenizer tokenizer(text);
+    Token token;
+
+    while(tokenizer.next(token))
+    {
+        if(!token.is_quoted && is_keyword(token.text, "data_"))
+        {
+            finish_block(v_blocks, builders);
+            v_blocks.push_back({std::string(token.text.substr(5)), {}});
+        }
+        else if(!token.is_quoted && is_keyword(token.text, "loop_"))
+        {
+            // loop header: the list of tags
+            std::vector<std::string_view> v_tags;
+            Token next;
+            while(tokenizer.peek(next) && !next.is_quoted && starts_with(next.text, "_"))
+            {
+                tokenizer.next(next);
+                v_tags.push_back(next.text);
+            }
+
+            if(v_tags.empty())
+            {
+                throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: loop_ without tags at line {}", tokenizer.line_of(token.begin)));
+            }
+
+            std::string_view category = split_tag(v_tags[0]).first;
+            if(!is_requested(category))
+            {
+                if(tokenizer.peek(next)) tokenizer.skip_values(next.begin);
+                continue;
+            }
+
+            if(v_blocks.empty()) v_blocks.push_back({"", {}});
+
+            auto& builder = builders[std::string(category)];
+            builder = CategoryBuilder{};
+            for(auto tag : v_tags)
+            {
+                builder.add_item(split_tag(tag).second);
+            }
+
+            std::size_t n_values = 0;
+            while(tokenizer.peek(next) && !is_reserved(next))
+            {
+                tokenizer.next(next);
+                builder.cols[n_values % v_tags.size()]->emplace_back(next.text);
+                ++n_values;
+            }
+
+            if(n_values % v_tags.size() != 0)
+            {
+                throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: loop of {} has {} values which is not a multiple of its {} tags",
+                                                     category, n_values, v_tags.size()));
+            }
+        }
+        else if(!token.is_quoted && starts_with(token.text, "_"))
+        {
+            // single item: _category.item value
+            // a missing value must not swallow the next tag, loop_ or data_
+            Token value;
+            if(!tokenizer.peek(value) || is_reserved(value) || !tokenizer.next(value))
+            {
+                throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: missing value of {} at line {}", token.text, tokenizer.line_of(token.begin)));
+            }
+
+            auto [category, item] = split_tag(token.text);
+            if(!is_requested(category)) continue;
+
+            if(v_blocks.empty()) v_blocks.push_back({"", {}});
+
+            auto& builder = builders[std::string(category)];
+            builder.add_item(item);
+            builder.cols.back()->emplace_back(value.text);
+        }
+        // save_ frames and global_ blocks are not used by mmCIF, other values outside a loop are ignored
+    }
+
+    finish_block(v_blocks, builders);
+
+    return v_blocks;
+}
+
+std::vector<DF::CifBlock> DF::read_mmcif(std::string_view path, std::shorts::V_string const& categories)
+{
+    MappedFile file(path);
+    return read_mmcif_text(file.view(), categories);
+}
+
+void DF::DataFrame::read_mmcif(std::string_view path, std::string const& category)
+{
+    std::string name = category.empty() || category[0] == '_' ? category : "_" + category;
+
+    try
+    {
+        auto v_blocks = DF::read_mmcif(path, {name});
+
+        for(auto& block : v_blocks)
+        {
+            auto it = block.categories.find(name);
+            if(it != block.categories.end())
+            {
+                // copies every cell when the resources of the two frames differ
+                *this = std::move(it->second);
+                return;
+            }
+        }
+    }
+    catch(DF::memory_limit_error const&)
+    {
+        fail_load(path);
+    }
+
+    throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: category {} not found in file {}", name, path));
+}
@@ -1,8 +1,11 @@
 #include <algorithm>
+#include "AsyncReader.hpp"
 #include <exception>
+#include <filesystem>
 #include <fmt/os.h>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include "ReadFiles.hpp"
 #include <set>
 #include <sstream>
@@ -10,6 +13,98 @@
 #include <sys/ioctl.h>
 #include <unistd.h>
 
+namespace
+{
+    // size of a regular file (its lines hold about as many characters), 0 for pipes and other special files
+    std::size_t file_bytes(std::string_view path)
+    {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(std::filesystem::path(path), ec);
+        return ec ? 0 : static_cast<std::size_t>(size);
+    }
+
+    // memory held by a vector of strings, counting the characters only if they are not charged yet
+    std::size_t strings_bytes(std::shorts::V_string const& v_strs, bool is_chars_charged)
+    {
+        std::size_t n_bytes = sizeof(std::shorts::V_string) + v_strs.size() * sizeof(std::string);
+        if(!is_chars_charged)
+        {
+            for(auto const& str : v_strs) n_bytes += str.size();
+        }
+        return n_bytes;
+    }
+}
+
+DF::DataFrame::DataFrame()
+    : data(DF::default_resource())
+{
+}
+
+DF::DataFrame::DataFrame(std::pmr::memory_resource* mr)
+    : data(mr)
+{
+}
+
+DF::DataFrame::DataFrame(DataFrame const& other)
+    : n_rows(other.n_rows),
+      n_cols(other.n_cols),
+      mising_values(other.mising_values),
+      data(other.data, other.data.get_allocator()),
+      headers(other.headers),
+      index(other.index),
+      follow_state(other.follow_state),
+      aggregates(other.aggregates)
+{
+}
+
+std::pmr::memory_resource* DF::DataFrame::get_memory_resource() const
+{
+    return data.get_allocator().resource();
+}
+
+DF::DataFrame DF::DataFrame::memory_usage(bool deep) const
+{
+    std::shorts::V_string v_hdrs;
+    std::shorts::V_string v_bytes;
+    std::size_t total = 0;
+
+    for(auto const& hdr : headers)
+    {
+        auto const& values = at(hdr);
+        std::size_t n_bytes = values.capacity() * sizeof(std::shorts::Column::value_type);
+
+        if(deep)
+        {
+            // short strings are stored inside the string object itself, with the capacity of an empty string
+            std::size_t local_capacity = std::pmr::string().capacity();
+            for(auto const& cell : values)
+            {
+                if(cell.capacity() > local_capacity) n_bytes += cell.capacity() + 1;
+            }
+        }
+
+        v_hdrs.push_back(hdr);
+        v_bytes.push_back(std::to_string(n_bytes));
+        total += n_bytes;
+    }
+
+    v_hdrs.push_back("total");
+    v_bytes.push_back(std::to_string(total));
+
+    DF::DataFrame usage;
+    usage.add_col(std::move(v_hdrs), "column");
+    usage.add_col(std::move(v_bytes), "bytes");
+    usage.n_rows = headers.size() + 1;
+
+    return usage;
+}
+
+void DF::DataFrame::fail_load(std::string_view source)
+{
+    clear();
+    throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: loading {} exceeds the memory limit of {} bytes", source, DF::get_memory_limit()));
+}
+
 int DF::DataFrame::get_n_cols() const
 {
     return n_cols;
@@ -125,12 +220,18 @@ void DF::DataFrame::fill_data_whitespace(std::shorts::V_string const& v_lines, b
 {
     std::shorts::VV_string vv_strs;
 
+    // the cells are held outside of the memory resource until they are copied into the columns
+    DF::MemoryReservation reservation;
     for(auto const& line : v_lines)
     {
         std::shorts::V_string v_str_tmp = parse_line_whitespace(line);
-        vv_strs.emplace_back(v_str_tmp);
+        reservation.add(strings_bytes(v_str_tmp, false));
+        vv_strs.emplace_back(std::move(v_str_tmp));
     }
 
+    data.clear();
+    reset_state();
+
     //initialize n_rows and n_cols
     n_rows = vv_strs.size();
     n_cols = vv_strs[0].size();
@@ -163,7 +264,8 @@ void DF::DataFrame::fill_data_whitespace(std::shorts::V_string const& v_lines, b
 
     for(unsigned long long i_col{0}; i_col < n_cols; ++i_col)
     {
-        std::shorts::V_string values;
+        std::shorts::Column values(get_memory_resource());
+        values.reserve(n_rows);
         for(unsigned long long i_row{is_first_col_header}; i_row < n_rows; ++i_row)
         {
             if(vv_strs[i_row].size() != n_cols)
@@ -183,7 +285,7 @@ void DF::DataFrame::fill_data_whitespace(std::shorts::V_string const& v_lines, b
             }
         }
 
-        data[headers[i_col]] = values;
+        data[headers[i_col]] = std::move(values);
     }
 }
 
@@ -191,12 +293,23 @@ void DF::DataFrame::fill_data(std::shorts::V_string const& lines, char delim, bo
 {
     std::shorts::VV_string vv_strs;
     
+    // the cells are held outside of the memory resource until they are copied into the columns
+    DF::MemoryReservation reservation;
     for(auto const& line : lines)
     {
         std::shorts::V_string v_str_tmp = parse_line(line, delim);
-        vv_strs.emplace_back(v_str_tmp);
+        reservation.add(strings_bytes(v_str_tmp, false));
+        vv_strs.emplace_back(std::move(v_str_tmp));
     }
 
+    fill_rows(vv_strs, is_first_col_header, v_hdrs);
+}
+
+void DF::DataFrame::fill_rows(std::shorts::VV_string const& vv_strs, bool is_first_col_header, std::shorts::V_string v_hdrs)
+{
+    data.clear();
+    reset_state();
+
     // init n_rows and n_cols
     n_rows = vv_strs.size();
     n_cols = vv_strs[0].size();
@@ -229,7 +342,8 @@ void DF::DataFrame::fill_data(std::shorts::V_string const& lines, char delim, bo
 
     for(unsigned long long i_col{0}; i_col < n_cols; ++i_col)
     {
-        std::shorts::V_string values;
+        std::shorts::Column values(get_memory_resource());
+        values.reserve(n_rows);
         for(unsigned long long i_row{is_first_col_header}; i_row < n_rows; ++i_row)
         {
             if(vv_strs[i_row].size() != n_cols)
@@ -249,19 +363,26 @@ void DF::DataFrame::fill_data(std::shorts::V_string const& lines, char delim, bo
             }
         }
 
-        data[headers[i_col]] = values;
+        data[headers[i_col]] = std::move(values);
     }
 }
 
 void DF::DataFrame::fill_data(std::shorts::V_string const& lines, std::shorts::V_pair_ints const& v_cols_start_length, bool is_first_col_header, std::shorts::V_string v_hdrs)
 {
     std::shorts::VV_string vv_strs;
+
+    // the cells are held outside of the memory resource until they are copied into the columns
+    DF::MemoryReservation reservation;
     for(auto const& line : lines)
     {
         auto v_str_tmp = parse_line(line, v_cols_start_length);
-        vv_strs.emplace_back(v_str_tmp);
+        reservation.add(strings_bytes(v_str_tmp, false));
+        vv_strs.emplace_back(std::move(v_str_tmp));
     }
 
+    data.clear();
+    reset_state();
+
     // init n_rows and n_cols
     n_rows = vv_strs.size();
     n_cols = vv_strs[0].size();
@@ -294,7 +415,8 @@ void DF::DataFrame::fill_data(std::shorts::V_string const& lines, std::shorts::V
 
     for(unsigned long long i_col{0}; i_col < n_cols; ++i_col)
     {
-        std::shorts::V_string values;
+        std::shorts::Column values(get_memory_resource());
+        values.reserve(n_rows);
         for(unsigned long long i_row{is_first_col_header}; i_row < n_rows; ++i_row)
         {
             if(vv_strs[i_row].size() != n_cols)
@@ -314,26 +436,142 @@ void DF::DataFrame::fill_data(std::shorts::V_string const& lines, std::shorts::V
             }
         }
 
-        data[headers[i_col]] = values;
+        data[headers[i_col]] = std::move(values);
+    }
+}
+
+std::vector<std::shorts::VV_string> DF::DataFrame::read_rows(std::shorts::V_string const& paths, char delim, DF::MemoryReservation& reservation)
+{
+    // the size of regular files is charged against the memory limit before they are read
+    std::size_t n_total_bytes = 0;
+    std::vector<std::size_t> v_file_bytes;
+    for(auto const& path : paths)
+    {
+        v_file_bytes.push_back(file_bytes(path));
+        n_total_bytes += v_file_bytes.back();
+    }
+    reservation.add(n_total_bytes);
+
+    std::vector<std::shorts::VV_string> vv_rows;
+    if(n_total_bytes >= DF::get_async_read_options().min_async_size && n_total_bytes > 0)
+    {
+        // large inputs: the workers split their chunks into rows of cells while the next chunks are read
+        bool is_regular = std::all_of(v_file_bytes.begin(), v_file_bytes.end(), [](std::size_t n_bytes) { return n_bytes > 0; });
+        if(is_regular)
+        {
+            vv_rows = DF::read_rows_async(paths, [this, delim](std::string const& line) { return parse_line(line, delim); });
+            for(auto const& rows : vv_rows)
+            {
+                for(auto const& row : rows) reservation.add(strings_bytes(row, true));
+            }
+            return vv_rows;
+        }
+    }
+
+    // small inputs, pipes and other special files are read line by line
+    for(std::size_t i_file{0}; i_file < paths.size(); ++i_file)
+    {
+        auto lines = read_lines(std::string_view(paths[i_file]));
+        reservation.add(strings_bytes(lines, v_file_bytes[i_file] > 0));
+
+        std::shorts::VV_string rows;
+        rows.reserve(lines.size());
+        for(auto const& line : lines)
+        {
+            rows.push_back(parse_line(line, delim));
+            reservation.add(strings_bytes(rows.back(), false));
+        }
+        vv_rows.push_back(std::move(rows));
+    }
+
+    return vv_rows;
+}
+
+void DF::DataFrame::load_files(std::shorts::V_string const& paths, char delim, bool is_first_col_header, std::shorts::V_string v_hdrs)
+{
+    DF::MemoryReservation reservation;
+    auto vv_rows = read_rows(paths, delim, reservation);
+
+    // the rows of all files are concatenated, the header is kept from the first file only
+    std::size_t n_rows_total = 0;
+    for(auto const& rows : vv_rows) n_rows_total += rows.size();
+    reservation.add(n_rows_total * sizeof(std::shorts::V_string));
+
+    std::shorts::VV_string rows;
+    rows.reserve(n_rows_total);
+    for(std::size_t i_file{0}; i_file < paths.size(); ++i_file)
+    {
+        auto& file_rows = vv_rows[i_file];
+        auto first = file_rows.begin();
+        if(is_first_col_header && !rows.empty() && !file_rows.empty())
+        {
+            if(file_rows[0] != rows[0])
+            {
+                throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: the header of {} differs from the header of the first file", paths[i_file]));
+            }
+            ++first;
+        }
+        std::move(first, file_rows.end(), std::back_inserter(rows));
+        file_rows.clear();
     }
+
+    fill_rows(rows, is_first_col_header, v_hdrs);
 }
 
 void DF::DataFrame::read_files(std::string_view path, char delim, bool is_first_col_header, std::shorts::V_string v_hdrs)
 {
-    auto lines = read_lines(path);
-    fill_data(lines, delim, is_first_col_header, v_hdrs);
+    try
+    {
+        load_files({std::string(path)}, delim, is_first_col_header, v_hdrs);
+    }
+    catch(DF::memory_limit_error const&)
+    {
+        fail_load(path);
+    }
+}
+
+void DF::DataFrame::read_files(std::shorts::V_string const& paths, char delim, bool is_first_col_header, std::shorts::V_string v_hdrs)
+{
+    try
+    {
+        load_files(paths, delim, is_first_col_header, v_hdrs);
+    }
+    catch(DF::memory_limit_error const&)
+    {
+        fail_load(fmt::format("{} files", paths.size()));
+    }
 }
 
 void DF::DataFrame::read_text(std::string const& text,std::shorts::V_pair_ints const& v_cols_start_length, bool is_first_col_header, std::shorts::V_string v_hdrs)
 {
-    auto lines = read_lines(text);
-    fill_data(lines, v_cols_start_length, is_first_col_header, v_hdrs);
+    try
+    {
+        DF::MemoryReservation reservation;
+        reservation.add(text.size());
+        auto lines = read_lines(text);
+        reservation.add(strings_bytes(lines, true));
+        fill_data(lines, v_cols_start_length, is_first_col_header, v_hdrs);
+    }
+    catch(DF::memory_limit_error const&)
+    {
+        fail_load("text");
+    }
 }
 
 void DF::DataFrame::read_text_whitespace(std::string const& text, bool is_first_col_header, std::shorts::V_string v_hdrs)
 {
-    auto lines = read_lines(text);
-    fill_data_whitespace(lines, is_first_col_header, v_hdrs);
+    try
+    {
+        DF::MemoryReservation reservation;
+        reservation.add(text.size());
+        auto lines = read_lines(text);
+        reservation.add(strings_bytes(lines, true));
+        fill_data_whitespace(lines, is_first_col_header, v_hdrs);
+    }
+    catch(DF::memory_limit_error const&)
+    {
+        fail_load("text");
+    }
 }
 
 void DF::DataFrame::head(unsigned long long n)
@@ -462,16 +700,32 @@ std::shorts::V_string DF::DataFrame::get_headers() const
 void DF::DataFrame::set_headers(std::shorts::V_string const& v_hdrs)
 {
     headers = v_hdrs;
+    if(!index.empty()) index.is_stale = true;
 }
 
-std::shorts::V_string DF::DataFrame::get_by_header(std::string const& hdr)
+std::shorts::V_string DF::DataFrame::get_by_header(std::string const& hdr) const
 {
-    return data[hdr];
+    // a missing header gives an empty column without inserting one
+    auto it = data.find(hdr);
+    if(it == data.end()) return {};
+
+    return std::shorts::V_string(it->second.begin(), it->second.end());
+}
+
+std::shorts::Column const& DF::DataFrame::at(std::string const& hdr) const
+{
+    auto it = data.find(hdr);
+    if(it == data.end())
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: header {} does not exist.\nPlease check your input.", hdr));
+    }
+
+    return it->second;
 }
 
 DF::DataFrame DF::DataFrame::copy_by_headers(std::shorts::V_string const& v_hdrs)
 {
-    DF::DataFrame new_df;
+    DF::DataFrame new_df(get_memory_resource());
     new_df.n_cols = v_hdrs.size();
     new_df.n_rows = n_rows;
     new_df.headers = v_hdrs;
@@ -492,21 +746,21 @@ void DF::DataFrame::swap_cols_pos(std::string first_hdr, std::string second_hdr)
     auto second_it = std::find(headers.begin(), headers.end(), second_hdr);
     swap(headers[first_it - headers.begin()], headers[second_it - headers.begin()]);
 
+    mark_index_stale(first_hdr);
+    mark_index_stale(second_hdr);
     std::swap(data[first_hdr], data[second_hdr]);
 }
 
-void DF::DataFrame::insert_col(std::shorts::V_string const& values, std::string hdr)
+void DF::DataFrame::insert_col(std::shorts::Column values, std::string hdr)
 {
-    auto [_it, inserted] = data.insert({hdr, values});
-    
     int n = 1;
     std::string original_hdr = hdr;
 
-    while (!inserted)
+    while (data.count(hdr) > 0)
     {
         hdr = fmt::format("{}_{}", original_hdr, n++);
-        std::tie(_it, inserted) = data.insert({hdr, values});
     }
+    data.emplace(hdr, std::move(values));
     headers.push_back(hdr);
     n_cols++;
 }
@@ -514,25 +768,35 @@ void DF::DataFrame::insert_col(std::shorts::V_string const& values, std::string
 void DF::DataFrame::add_col(std::shorts::V_string const& values, std::string hdr)
                            
 {
-    insert_col(values, hdr);
+    insert_col(std::shorts::Column(values.begin(), values.end(), get_memory_resource()), hdr);
+}
+
+void DF::DataFrame::add_col(std::shorts::V_string&& values, std::string hdr)
+{
+    // the cells have to be copied into the memory resource of the data frame
+    insert_col(std::shorts::Column(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()), get_memory_resource()), hdr);
+    values.clear();
 }
 
 void DF::DataFrame::add_col_of(std::string const& value, std::string hdr)
 {
-    std::shorts::V_string values(data[headers[0]].size(), value);
-    insert_col(values, hdr);
+    std::shorts::Column values(data[headers[0]].size(), std::pmr::string(value), get_memory_resource());
+    insert_col(std::move(values), hdr);
 }
 
 void DF::DataFrame::clear()
 {
     headers.clear();
     data.clear();
+    reset_state();
 }
 
 void DF::DataFrame::append(std::vector<DF::DataFrame>&& v_dfs)
 {
     if(v_dfs.empty()) return;
 
+    std::size_t n_old_rows = headers.empty() ? 0 : data[headers[0]].size();
+
     for(auto& curr_df : v_dfs)
     {
         if(headers == curr_df.get_headers())
@@ -546,13 +810,145 @@ void DF::DataFrame::append(std::vector<DF::DataFrame>&& v_dfs)
     }
     n_rows = data[headers[0]].size();
     n_cols = headers.size();
+
+    // only the appended rows are added to the index and the aggregates
+    if(!index.empty() && !index.is_stale)
+    {
+        index.extend(index_cols(), n_old_rows);
+    }
+    update_aggregates(n_old_rows);
 }
 
-std::shorts::V_string&  DF::DataFrame::operator[](std::string hdr)
+std::shorts::Column&  DF::DataFrame::operator[](std::string hdr)
 {
+    // the caller may modify the column, so an index on it has to be rebuilt
+    mark_index_stale(hdr);
+
     return data[hdr];
 }
 
+std::shorts::Column const& DF::DataFrame::operator[](std::string const& hdr) const
+{
+    return at(hdr);
+}
+
+void DF::DataFrame::mark_index_stale(std::string const& hdr)
+{
+    auto const& index_hdrs = index.get_headers();
+    if(std::find(index_hdrs.begin(), index_hdrs.end(), hdr) != index_hdrs.end())
+    {
+        index.is_stale = true;
+    }
+}
+
+DF::RowIndex::V_cols DF::DataFrame::index_cols() const
+{
+    RowIndex::V_cols v_cols;
+    for(auto const& hdr : index.get_headers())
+    {
+        v_cols.push_back(&at(hdr));
+    }
+
+    return v_cols;
+}
+
+void DF::DataFrame::check_index() const
+{
+    if(index.empty())
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: the data frame has no index, call set_index first"));
+    }
+
+    // lookups are const and may run concurrently, so they never rebuild the index themselves
+    if(index.is_stale)
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: the index on {} is stale because a key column was accessed through operator[], call reindex first", index.get_headers()));
+    }
+}
+
+void DF::DataFrame::set_index(std::shorts::V_string const& v_hdrs, IndexType type)
+{
+    RowIndex::V_cols v_cols;
+    for(auto const& hdr : v_hdrs)
+    {
+        v_cols.push_back(&at(hdr));
+    }
+
+    index.build(v_hdrs, v_cols, type);
+}
+
+void DF::DataFrame::reset_index()
+{
+    index.clear();
+}
+
+void DF::DataFrame::reindex()
+{
+    if(index.empty())
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: the data frame has no index, call set_index first"));
+    }
+
+    auto v_hdrs = index.get_headers();
+    index.build(v_hdrs, index_cols(), index.get_type());
+}
+
+void DF::DataFrame::reset_state()
+{
+    index.clear();
+    follow_state = FollowState{};
+    aggregates.clear();
+}
+
+std::shorts::V_string DF::DataFrame::get_index_headers() const
+{
+    return index.get_headers();
+}
+
+std::vector<std::size_t> DF::DataFrame::find_rows(std::shorts::V_string const& key) const
+{
+    check_index();
+    return index.find(key);
+}
+
+bool DF::DataFrame::contains(std::shorts::V_string const& key) const
+{
+    check_index();
+    return index.contains(key);
+}
+
+DF::DataFrame DF::DataFrame::loc(std::shorts::V_string const& key) const
+{
+    return take(find_rows(key));
+}
+
+DF::DataFrame DF::DataFrame::loc(std::shorts::V_string const& first, std::shorts::V_string const& last) const
+{
+    check_index();
+    return take(index.range(first, last));
+}
+
+DF::DataFrame DF::DataFrame::take(std::vector<std::size_t> const& v_rows) const
+{
+    DF::DataFrame new_df(get_memory_resource());
+    new_df.n_cols = headers.size();
+    new_df.n_rows = v_rows.size();
+    new_df.headers = headers;
+
+    for(auto const& hdr : headers)
+    {
+        auto const& values = at(hdr);
+        auto& new_values = new_df.data[hdr];
+        new_values.reserve(v_rows.size());
+        for(auto i_row : v_rows)
+        {
+            new_values.push_back(values.at(i_row));
+        }
+    }
+
+    return new_df;
+}
+
 void DF::DataFrame::write(std::string_view path, char delimiter)
 {
     fmt::ostream out = fmt::output_file(path.data());
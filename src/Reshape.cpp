@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "Parallel.hpp"
+#include "ReadFiles.hpp"
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+    /**
+     * @brief number the distinct values of a column in order of their first appearance
+     *
+     * @param values column
+     * @param v_ids id of the value of each row
+     * @return distinct values
+     */
+    std::vector<std::string_view> assign_ids(std::shorts::Column const& values, std::vector<std::size_t>& v_ids)
+    {
+        std::unordered_map<std::string_view, std::size_t> ids;
+        std::vector<std::string_view> keys;
+        v_ids.resize(values.size());
+
+        for(std::size_t i_row{0}; i_row < values.size(); ++i_row)
+        {
+            auto [it, is_new] = ids.emplace(values[i_row], keys.size());
+            if(is_new) keys.emplace_back(values[i_row]);
+            v_ids[i_row] = it->second;
+        }
+
+        return keys;
+    }
+}
+
+DF::DataFrame DF::DataFrame::pivot(std::string const& index_hdr, std::string const& columns_hdr, std::string const& values_hdr, Aggregation agg) const
+{
+    auto const& index_values = at(index_hdr);
+    auto const& column_values = at(columns_hdr);
+    auto const& values = at(values_hdr);
+    std::size_t n = values.size();
+
+    std::vector<std::size_t> v_row_ids, v_col_ids;
+    auto row_keys = assign_ids(index_values, v_row_ids);
+    auto col_keys = assign_ids(column_values, v_col_ids);
+
+    // scatter: group the input rows by output column (stable counting sort) so each output column is gathered by one thread
+    std::vector<std::size_t> col_start(col_keys.size() + 1, 0);
+    for(auto i_col : v_col_ids) ++col_start[i_col + 1];
+    for(std::size_t i_col{0}; i_col < col_keys.size(); ++i_col) col_start[i_col + 1] += col_start[i_col];
+
+    std::vector<std::size_t> v_order(n);
+    std::vector<std::size_t> v_next(col_start.begin(), col_start.end() - 1);
+    for(std::size_t i_row{0}; i_row < n; ++i_row) v_order[v_next[v_col_ids[i_row]]++] = i_row;
+
+    std::vector<std::shorts::Column> v_out;
+    v_out.reserve(col_keys.size());
+    for(std::size_t i_col{0}; i_col < col_keys.size(); ++i_col) v_out.emplace_back(get_memory_resource());
+
+    // the cells are allocated by the worker threads, on one thread if the resource is not thread-safe
+    std::size_t n_threads = DF::is_thread_safe(get_memory_resource()) ? 0 : 1;
+    DF::parallel_tasks(col_keys.size(), [&](std::size_t i_col)
+    {
+        auto& cells = v_out[i_col];
+        cells.resize(row_keys.size(), "NA");
+        std::vector<std::size_t> v_seen(row_keys.size(), 0);
+
+        if(agg == Aggregation::first || agg == Aggregation::last)
+        {
+            for(std::size_t i{col_start[i_col]}; i < col_start[i_col + 1]; ++i)
+            {
+                std::size_t i_row = v_order[i];
+                std::size_t i_out = v_row_ids[i_row];
+                if(agg == Aggregation::last || v_seen[i_out]++ == 0) cells[i_out] = values[i_row];
+            }
+            return;
+        }
+
+        double init = agg == Aggregation::min ? std::numeric_limits<double>::infinity()
+                    : agg == Aggregation::max ? -std::numeric_limits<double>::infinity() : 0.0;
+        std::vector<double> v_acc(row_keys.size(), init);
+        std::vector<std::size_t> v_count(row_keys.size(), 0);
+
+        for(std::size_t i{col_start[i_col]}; i < col_start[i_col + 1]; ++i)
+        {
+            std::size_t i_row = v_order[i];
+            std::size_t i_out = v_row_ids[i_row];
+            ++v_seen[i_out];
+
+            double value = DF::parse_cell<double>(values[i_row], values_hdr, i_row);
+            if(std::isnan(value)) continue;
+
+            ++v_count[i_out];
+            if(agg == Aggregation::min) v_acc[i_out] = std::min(v_acc[i_out], value);
+            else if(agg == Aggregation::max) v_acc[i_out] = std::max(v_acc[i_out], value);
+            else v_acc[i_out] += value;
+        }
+
+        for(std::size_t i_out{0}; i_out < row_keys.size(); ++i_out)
+        {
+            if(v_seen[i_out] == 0) continue;
+
+            if(agg == Aggregation::count) cells[i_out] = DF::to_cell(v_count[i_out]);
+            else if(agg == Aggregation::sum) cells[i_out] = DF::to_cell(v_acc[i_out]);
+            else if(v_count[i_out] > 0)
+            {
+                double result = agg == Aggregation::mean ? v_acc[i_out] / static_cast<double>(v_count[i_out]) : v_acc[i_out];
+                cells[i_out] = DF::to_cell(result);
+            }
+        }
+    }, n_threads);
+
+    DF::DataFrame result(get_memory_resource());
+    result.insert_col(std::shorts::Column(row_keys.begin(), row_keys.end(), get_memory_resource()), index_hdr);
+    for(std::size_t i_col{0}; i_col < col_keys.size(); ++i_col)
+    {
+        result.insert_col(std::move(v_out[i_col]), std::string(col_keys[i_col]));
+    }
+    result.n_rows = row_keys.size();
+
+    return result;
+}
+
+DF::DataFrame DF::DataFrame::melt(std::shorts::V_string const& id_vars, std::shorts::V_string const& value_vars,
+                                  std::string const& var_name, std::string const& value_name) const
+{
+    std::vector<std::shorts::Column const*> v_ids;
+    for(auto const& hdr : id_vars) v_ids.push_back(&at(hdr));
+
+    std::shorts::V_string v_value_hdrs = value_vars;
+    if(v_value_hdrs.empty())
+    {
+        for(auto const& hdr : headers)
+        {
+            if(std::find(id_vars.begin(), id_vars.end(), hdr) == id_vars.end()) v_value_hdrs.push_back(hdr);
+        }
+    }
+
+    std::vector<std::shorts::Column const*> v_values;
+    for(auto const& hdr : v_value_hdrs) v_values.push_back(&at(hdr));
+
+    std::size_t n = headers.empty() ? 0 : at(headers[0]).size();
+    std::size_t m = v_values.size();
+
+    // every output column is preallocated, each value column fills its own block of n rows
+    std::vector<std::shorts::Column> v_out;
+    v_out.reserve(v_ids.size() + 2);
+    for(std::size_t i_col{0}; i_col < v_ids.size() + 2; ++i_col)
+    {
+        v_out.emplace_back(n * m, get_memory_resource());
+    }
+    auto& variables = v_out[v_ids.size()];
+    auto& cells = v_out[v_ids.size() + 1];
+
+    // the cells are allocated by the worker threads, on one thread if the resource is not thread-safe
+    std::size_t n_threads = DF::is_thread_safe(get_memory_resource()) ? 0 : 1;
+    DF::parallel_tasks(m, [&](std::size_t i_var)
+    {
+        std::size_t first = i_var * n;
+        for(std::size_t i_id{0}; i_id < v_ids.size(); ++i_id)
+        {
+            std::copy(v_ids[i_id]->begin(), v_ids[i_id]->end(), v_out[i_id].begin() + first);
+        }
+        std::fill(variables.begin() + first, variables.begin() + first + n, v_value_hdrs[i_var]);
+        std::copy(v_values[i_var]->begin(), v_values[i_var]->end(), cells.begin() + first);
+    }, n_threads);
+
+    DF::DataFrame result(get_memory_resource());
+    for(std::size_t i_id{0}; i_id < v_ids.size(); ++i_id) result.insert_col(std::move(v_out[i_id]), id_vars[i_id]);
+    result.insert_col(std::move(variables), var_name);
+    result.insert_col(std::move(cells), value_name);
+    result.n_rows = n * m;
+
+    return result;
+}
+
+DF::DataFrame DF::DataFrame::transpose(std::string const& header_hdr) const
+{
+    std::shorts::Column const* new_hdrs = header_hdr.empty() ? nullptr : &at(header_hdr);
+
+    std::vector<std::shorts::Column const*> v_cols;
+    std::shorts::V_string v_col_hdrs;
+    for(auto const& hdr : headers)
+    {
+        if(hdr == header_hdr) continue;
+        v_cols.push_back(&data.at(hdr));
+        v_col_hdrs.push_back(hdr);
+    }
+
+    std::size_t n = headers.empty() ? 0 : at(headers[0]).size();
+    std::size_t k = v_cols.size();
+
+    std::vector<std::shorts::Column> v_out;
+    v_out.reserve(n);
+    for(std::size_t i_row{0}; i_row < n; ++i_row) v_out.emplace_back(get_memory_resource());
+
+    // gather: each thread builds the output columns of a block of input rows,
+    // on one thread if the resource is not thread-safe
+    std::size_t n_threads = DF::is_thread_safe(get_memory_resource()) ? 0 : 1;
+    DF::parallel_for(n, [&](std::size_t begin, std::size_t end)
+    {
+        for(std::size_t i_row{begin}; i_row < end; ++i_row)
+        {
+            auto& cells = v_out[i_row];
+            cells.resize(k);
+            for(std::size_t i_col{0}; i_col < k; ++i_col) cells[i_col] = (*v_cols[i_col])[i_row];
+        }
+    }, 256, n_threads);
+
+    DF::DataFrame result(get_memory_resource());
+    result.insert_col(std::shorts::Column(v_col_hdrs.begin(), v_col_hdrs.end(), get_memory_resource()), "column");
+    for(std::size_t i_row{0}; i_row < n; ++i_row)
+    {
+        result.insert_col(std::move(v_out[i_row]), new_hdrs == nullptr ? std::to_string(i_row + 1) : std::string((*new_hdrs)[i_row]));
+    }
+    result.n_rows = k;
+
+    return result;
+}
@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include "fmt/color.h"
+#include "fmt/format.h"
+#include "fmt/ranges.h"
+#include <limits>
+#include <numeric>
+#include "RowIndex.hpp"
+#include <stdexcept>
+#include "TypedColumn.hpp"
+
+namespace
+{
+    // separator between the cells of a composite key, sorts before every printable character
+    constexpr char key_separator = '\x1f';
+
+    // like DF::parse_cell<double>, but reports cells which are not numbers instead of throwing
+    bool parse_number(std::string_view cell, double& value)
+    {
+        while(!cell.empty() && cell.front() == ' ') cell.remove_prefix(1);
+        while(!cell.empty() && cell.back() == ' ') cell.remove_suffix(1);
+
+        if(DF::is_missing(cell))
+        {
+            value = std::numeric_limits<double>::quiet_NaN();
+            return true;
+        }
+        if(cell.size() > 1 && cell.front() == '+') cell.remove_prefix(1);
+
+        auto [ptr, ec] = std::from_chars(cell.data(), cell.data() + cell.size(), value);
+        return ec == std::errc() && ptr == cell.data() + cell.size();
+    }
+
+    // missing values (NaN) are equal to each other and ordered after all numbers
+    int compare_numbers(double lhs, double rhs)
+    {
+        if(std::isnan(lhs) || std::isnan(rhs)) return std::isnan(lhs) == std::isnan(rhs) ? 0 : (std::isnan(lhs) ? 1 : -1);
+        return lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+    }
+}
+
+std::string DF::RowIndex::make_key(std::vector<std::string> const& key) const
+{
+    if(key.size() != headers.size())
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: the key has {} values but the index has {} columns", key.size(), headers.size()));
+    }
+
+    if(key.size() == 1) return key[0];
+
+    std::string joined;
+    for(std::size_t i{0}; i < key.size(); ++i)
+    {
+        if(i > 0) joined += key_separator;
+        joined += key[i];
+    }
+
+    return joined;
+}
+
+std::string DF::RowIndex::make_key(V_cols const& v_cols, std::size_t i_row) const
+{
+    if(v_cols.size() == 1) return std::string((*v_cols[0])[i_row]);
+
+    std::string joined;
+    for(std::size_t i{0}; i < v_cols.size(); ++i)
+    {
+        if(i > 0) joined += key_separator;
+        joined += (*v_cols[i])[i_row];
+    }
+
+    return joined;
+}
+
+void DF::RowIndex::insert_rows(V_cols const& v_cols, std::size_t first_row)
+{
+    std::size_t n_rows = v_cols.empty() ? 0 : v_cols[0]->size();
+    for(auto const* col : v_cols)
+    {
+        if(col->size() != n_rows)
+        {
+            throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: key columns of the index have different lengths"));
+        }
+    }
+
+    if(type == IndexType::hash)
+    {
+        hash_rows.reserve(n_rows);
+        for(std::size_t i_row{first_row}; i_row < n_rows; ++i_row)
+        {
+            hash_rows.emplace(make_key(v_cols, i_row), i_row);
+        }
+    }
+    else
+    {
+        if(sorted_keys.empty()) sorted_keys.resize(v_cols.size());
+
+        // a numeric key column which receives a cell that is not a number is compared as strings from now on
+        bool is_resorted = false;
+        for(std::size_t i_col{0}; i_col < v_cols.size(); ++i_col)
+        {
+            auto const& values = *v_cols[i_col];
+            auto& key = sorted_keys[i_col];
+
+            if(key.is_numeric)
+            {
+                key.numbers.resize(n_rows);
+                for(std::size_t i_row{first_row}; i_row < n_rows; ++i_row)
+                {
+                    if(!parse_number(values[i_row], key.numbers[i_row]))
+                    {
+                        key.is_numeric = false;
+                        key.numbers = {};
+                        key.strings.assign(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(first_row));
+                        is_resorted = first_row > 0;
+                        break;
+                    }
+                }
+            }
+
+            if(!key.is_numeric)
+            {
+                key.strings.reserve(n_rows);
+                for(std::size_t i_row{key.strings.size()}; i_row < n_rows; ++i_row) key.strings.emplace_back(values[i_row]);
+            }
+        }
+
+        auto is_less = [this](std::size_t lhs, std::size_t rhs) { return compare_rows(lhs, rhs) < 0; };
+        if(is_resorted)
+        {
+            sorted_rows.resize(n_rows);
+            std::iota(sorted_rows.begin(), sorted_rows.end(), std::size_t{0});
+            std::stable_sort(sorted_rows.begin(), sorted_rows.end(), is_less);
+        }
+        else
+        {
+            // sort only the new rows and merge them with the already sorted ones
+            auto mid = static_cast<std::ptrdiff_t>(sorted_rows.size());
+            for(std::size_t i_row{first_row}; i_row < n_rows; ++i_row) sorted_rows.push_back(i_row);
+            std::stable_sort(sorted_rows.begin() + mid, sorted_rows.end(), is_less);
+            std::inplace_merge(sorted_rows.begin(), sorted_rows.begin() + mid, sorted_rows.end(), is_less);
+        }
+    }
+
+    n_indexed = n_rows;
+}
+
+void DF::RowIndex::build(std::vector<std::string> const& v_hdrs, V_cols const& v_cols, IndexType index_type)
+{
+    if(v_hdrs.empty())
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: an index needs at least one key column"));
+    }
+
+    clear();
+    headers = v_hdrs;
+    type = index_type;
+    insert_rows(v_cols, 0);
+    is_built = true;
+}
+
+void DF::RowIndex::extend(V_cols const& v_cols, std::size_t first_row)
+{
+    if(!is_built) return;
+
+    if(first_row != n_indexed)
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: index covers {} rows but extension starts at row {}", n_indexed, first_row));
+    }
+
+    insert_rows(v_cols, first_row);
+}
+
+void DF::RowIndex::clear()
+{
+    headers.clear();
+    hash_rows.clear();
+    sorted_keys.clear();
+    sorted_rows.clear();
+    n_indexed = 0;
+    is_built = false;
+    is_stale = false;
+}
+
+bool DF::RowIndex::empty() const
+{
+    return !is_built;
+}
+
+int DF::RowIndex::compare_rows(std::size_t lhs, std::size_t rhs) const
+{
+    for(auto const& key : sorted_keys)
+    {
+        int result = key.is_numeric ? compare_numbers(key.numbers[lhs], key.numbers[rhs]) : key.strings[lhs].compare(key.strings[rhs]);
+        if(result != 0) return result;
+    }
+
+    return 0;
+}
+
+int DF::RowIndex::compare_to_key(std::size_t i_row, std::vector<double> const& numbers, std::vector<std::string> const& key) const
+{
+    for(std::size_t i_col{0}; i_col < sorted_keys.size(); ++i_col)
+    {
+        auto const& sorted_key = sorted_keys[i_col];
+        int result = sorted_key.is_numeric ? compare_numbers(sorted_key.numbers[i_row], numbers[i_col]) : sorted_key.strings[i_row].compare(key[i_col]);
+        if(result != 0) return result;
+    }
+
+    return 0;
+}
+
+bool DF::RowIndex::parse_key(std::vector<std::string> const& key, std::vector<double>& numbers) const
+{
+    if(key.size() != headers.size())
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: the key has {} values but the index has {} columns", key.size(), headers.size()));
+    }
+
+    numbers.assign(key.size(), 0.0);
+    for(std::size_t i_col{0}; i_col < sorted_keys.size(); ++i_col)
+    {
+        if(sorted_keys[i_col].is_numeric && !parse_number(key[i_col], numbers[i_col])) return false;
+    }
+
+    return true;
+}
+
+DF::RowIndex::V_rows::const_iterator DF::RowIndex::lower_bound(std::vector<double> const& numbers, std::vector<std::string> const& key) const
+{
+    return std::lower_bound(sorted_rows.begin(), sorted_rows.end(), std::size_t{0},
+                            [&](std::size_t i_row, std::size_t) { return compare_to_key(i_row, numbers, key) < 0; });
+}
+
+DF::RowIndex::V_rows DF::RowIndex::find(std::vector<std::string> const& key) const
+{
+    V_rows v_rows;
+
+    if(type == IndexType::hash)
+    {
+        auto [first, last] = hash_rows.equal_range(make_key(key));
+        for(auto it = first; it != last; ++it)
+        {
+            v_rows.push_back(it->second);
+        }
+        std::sort(v_rows.begin(), v_rows.end());
+    }
+    else
+    {
+        // a key which is not a number has no match in a numeric key column
+        std::vector<double> numbers;
+        if(!parse_key(key, numbers)) return v_rows;
+
+        for(auto it = lower_bound(numbers, key); it != sorted_rows.end() && compare_to_key(*it, numbers, key) == 0; ++it)
+        {
+            v_rows.push_back(*it);
+        }
+    }
+
+    return v_rows;
+}
+
+bool DF::RowIndex::contains(std::vector<std::string> const& key) const
+{
+    if(type == IndexType::hash)
+    {
+        return hash_rows.find(make_key(key)) != hash_rows.end();
+    }
+
+    std::vector<double> numbers;
+    if(!parse_key(key, numbers)) return false;
+
+    auto it = lower_bound(numbers, key);
+    return it != sorted_rows.end() && compare_to_key(*it, numbers, key) == 0;
+}
+
+DF::RowIndex::V_rows DF::RowIndex::range(std::vector<std::string> const& first, std::vector<std::string> const& last) const
+{
+    if(type != IndexType::sorted)
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: range slicing needs a sorted index, use set_index(..., DF::IndexType::sorted)"));
+    }
+
+    std::vector<double> lower, upper;
+    if(!parse_key(first, lower) || !parse_key(last, upper))
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: the bounds {} and {} of the range must be numbers in the numeric key columns", first, last));
+    }
+
+    auto begin = lower_bound(lower, first);
+    auto end = std::upper_bound(begin, sorted_rows.cend(), std::size_t{0},
+                                [&](std::size_t, std::size_t i_row) { return compare_to_key(i_row, upper, last) > 0; });
+
+    return V_rows(begin, end);
+}
+
+std::vector<std::string> const& DF::RowIndex::get_headers() const
+{
+    return headers;
+}
+
+DF::IndexType DF::RowIndex::get_type() const
+{
+    return type;
+}
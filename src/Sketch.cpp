@@ -0,0 +1,634 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include "Parallel.hpp"
+#include "Sketch.hpp"
+#include <stdexcept>
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+    constexpr std::size_t block_size = 1 << 24;
+
+    // std::hash of strings is not guaranteed to spread its bits, finish it with the splitmix64 mixer
+    std::uint64_t hash_value(std::string_view value)
+    {
+        std::uint64_t h = std::hash<std::string_view>{}(value);
+        h += 0x9e3779b97f4a7c15ULL;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+
+    /**
+     * @brief call fn(cell) for each cell of a line, cells are cleaned like DataFrame::parse_line
+     * (quotes removed, and spaces too unless the delimiter is whitespace)
+     *
+     * @return number of cells
+     */
+    template<typename Fn>
+    std::size_t for_each_cell(std::string_view line, char delim, std::string& cell, Fn&& fn)
+    {
+        std::size_t n_cells = 0;
+        std::size_t pos = 0;
+
+        while(pos <= line.size())
+        {
+            if(delim == ' ')
+            {
+                while(pos < line.size() && std::isspace(static_cast<unsigned char>(line[pos]))) ++pos;
+                if(pos == line.size()) break;
+            }
+
+            std::size_t end = pos;
+            if(delim == ' ') while(end < line.size() && !std::isspace(static_cast<unsigned char>(line[end]))) ++end;
+            else end = std::min(line.find(delim, pos), line.size());
+
+            cell.clear();
+            for(std::size_t i{pos}; i < end; ++i)
+            {
+                if(line[i] == '\"' || (delim != ' ' && line[i] == ' ')) continue;
+                cell.push_back(line[i]);
+            }
+
+            fn(n_cells++, std::string_view(cell));
+
+            // a trailing delimiter does not start an empty cell, as with std::getline
+            if(end + 1 >= line.size()) break;
+            pos = end + 1;
+        }
+
+        return n_cells;
+    }
+}
+
+DF::HyperLogLog::HyperLogLog(unsigned p)
+    : precision(p)
+{
+    if(precision < 4 || precision > 18)
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: the precision of HyperLogLog must be between 4 and 18, got {}", precision));
+    }
+    registers.assign(std::size_t{1} << precision, 0);
+}
+
+void DF::HyperLogLog::add(std::string_view value)
+{
+    std::uint64_t h = hash_value(value);
+    std::size_t i_reg = h >> (64 - precision);
+
+    // rank: position of the first set bit after the index bits
+    std::uint64_t w = h << precision;
+    std::uint8_t rank = 1;
+    while(rank <= 64 - precision && (w & (std::uint64_t{1} << 63)) == 0)
+    {
+        ++rank;
+        w <<= 1;
+    }
+
+    registers[i_reg] = std::max(registers[i_reg], rank);
+}
+
+void DF::HyperLogLog::merge(HyperLogLog const& other)
+{
+    if(other.precision != precision)
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: unable to merge HyperLogLog sketches of precision {} and {}", precision, other.precision));
+    }
+    for(std::size_t i{0}; i < registers.size(); ++i) registers[i] = std::max(registers[i], other.registers[i]);
+}
+
+double DF::HyperLogLog::estimate() const
+{
+    auto m = static_cast<double>(registers.size());
+    double sum = 0.0;
+    std::size_t n_zeros = 0;
+    for(auto reg : registers)
+    {
+        sum += std::ldexp(1.0, -reg);
+        if(reg == 0) ++n_zeros;
+    }
+
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+
+    // small cardinalities: linear counting of the empty registers
+    if(estimate <= 2.5 * m && n_zeros > 0) estimate = m * std::log(m / static_cast<double>(n_zeros));
+
+    return estimate;
+}
+
+DF::TDigest::TDigest(double delta)
+    : compression(delta), min_value(std::numeric_limits<double>::infinity()), max_value(-std::numeric_limits<double>::infinity())
+{
+    if(!(compression >= 10.0))
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: the compression of a t-digest must be at least 10, got {}", compression));
+    }
+}
+
+void DF::TDigest::add(double value, double weight)
+{
+    if(std::isnan(value)) return;
+
+    buffer.push_back({value, weight});
+    total_weight += weight;
+    min_value = std::min(min_value, value);
+    max_value = std::max(max_value, value);
+
+    if(buffer.size() >= static_cast<std::size_t>(5 * compression)) compress();
+}
+
+void DF::TDigest::compress()
+{
+    if(buffer.empty()) return;
+
+    buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+    std::sort(buffer.begin(), buffer.end(), [](Centroid const& lhs, Centroid const& rhs) { return lhs.mean < rhs.mean; });
+
+    // scale function k1: a centroid may span at most one unit of k(q) = compression / (2 pi) * asin(2q - 1),
+    // k ends at compression / 4 (q = 1), beyond it sin would wrap around and limit the last centroids to single values
+    auto k = [this](double q) { return compression / (2.0 * pi) * std::asin(2.0 * q - 1.0); };
+    auto k_inverse = [this](double value) { return (std::sin(value * 2.0 * pi / compression) + 1.0) / 2.0; };
+    auto q_limit = [&](double q) { return k_inverse(std::min(k(q) + 1.0, compression / 4.0)); };
+
+    centroids.clear();
+    Centroid current = buffer[0];
+    double weight_before = 0.0;
+    double weight_limit = total_weight * q_limit(0.0);
+
+    for(std::size_t i{1}; i < buffer.size(); ++i)
+    {
+        if(weight_before + current.weight + buffer[i].weight <= weight_limit)
+        {
+            current.mean += (buffer[i].mean - current.mean) * buffer[i].weight / (current.weight + buffer[i].weight);
+            current.weight += buffer[i].weight;
+        }
+        else
+        {
+            weight_before += current.weight;
+            centroids.push_back(current);
+            weight_limit = total_weight * q_limit(std::min(1.0, weight_before / total_weight));
+            current = buffer[i];
+        }
+    }
+    centroids.push_back(current);
+    buffer.clear();
+}
+
+void DF::TDigest::merge(TDigest const& other)
+{
+    if(other.total_weight == 0.0) return;
+
+    buffer.insert(buffer.end(), other.centroids.begin(), other.centroids.end());
+    buffer.insert(buffer.end(), other.buffer.begin(), other.buffer.end());
+    total_weight += other.total_weight;
+    min_value = std::min(min_value, other.min_value);
+    max_value = std::max(max_value, other.max_value);
+    compress();
+}
+
+double DF::TDigest::quantile(double q) const
+{
+    if(!buffer.empty())
+    {
+        TDigest compressed = *this;
+        compressed.compress();
+        return compressed.quantile(q);
+    }
+
+    if(centroids.empty()) return std::numeric_limits<double>::quiet_NaN();
+    if(q <= 0.0) return min_value;
+    if(q >= 1.0) return max_value;
+
+    // interpolate between the centers of the centroids, and towards min and max at the ends
+    double target = q * total_weight;
+    double center = centroids[0].weight / 2.0;
+    if(target < center)
+    {
+        return min_value + (centroids[0].mean - min_value) * target / center;
+    }
+
+    for(std::size_t i{1}; i < centroids.size(); ++i)
+    {
+        double next_center = center + (centroids[i - 1].weight + centroids[i].weight) / 2.0;
+        if(target < next_center)
+        {
+            double t = (target - center) / (next_center - center);
+            return centroids[i - 1].mean + t * (centroids[i].mean - centroids[i - 1].mean);
+        }
+        center = next_center;
+    }
+
+    double rest = total_weight - center;
+    return rest <= 0.0 ? max_value : centroids.back().mean + (max_value - centroids.back().mean) * (target - center) / rest;
+}
+
+std::size_t DF::TDigest::n_centroids() const
+{
+    if(buffer.empty()) return centroids.size();
+
+    TDigest compressed = *this;
+    compressed.compress();
+    return compressed.centroids.size();
+}
+
+double DF::TDigest::count() const
+{
+    return total_weight;
+}
+
+double DF::TDigest::min() const
+{
+    return total_weight == 0.0 ? std::numeric_limits<double>::quiet_NaN() : min_value;
+}
+
+double DF::TDigest::max() const
+{
+    return total_weight == 0.0 ? std::numeric_limits<double>::quiet_NaN() : max_value;
+}
+
+DF::SpaceSaving::SpaceSaving(std::size_t n)
+    : n_counters(std::max<std::size_t>(1, n))
+{
+}
+
+std::uint64_t DF::SpaceSaving::min_count() const
+{
+    return counters.size() < n_counters ? 0 : by_count.begin()->first;
+}
+
+void DF::SpaceSaving::add(std::string_view value, std::uint64_t count)
+{
+    key.assign(value.data(), value.size());
+    auto it = positions.find(key);
+
+    if(it != positions.end())
+    {
+        auto& counter = counters[it->second];
+        by_count.erase({counter.count, it->second});
+        counter.count += count;
+        by_count.insert({counter.count, it->second});
+        return;
+    }
+
+    if(counters.size() < n_counters)
+    {
+        positions.emplace(key, counters.size());
+        by_count.insert({count, counters.size()});
+        counters.push_back({key, count, 0});
+        return;
+    }
+
+    // replace the least frequent value, the new value may have been counted there
+    auto [smallest, i_counter] = *by_count.begin();
+    by_count.erase(by_count.begin());
+    positions.erase(counters[i_counter].value);
+
+    counters[i_counter] = {key, smallest + count, smallest};
+    positions.emplace(key, i_counter);
+    by_count.insert({smallest + count, i_counter});
+}
+
+void DF::SpaceSaving::merge(SpaceSaving const& other)
+{
+    // a value not monitored by a sketch occurred at most min_count times there
+    std::uint64_t min_this = min_count();
+    std::uint64_t min_other = other.min_count();
+
+    std::vector<Counter> merged;
+    for(auto const& counter : counters)
+    {
+        auto it = other.positions.find(counter.value);
+        if(it != other.positions.end())
+        {
+            auto const& match = other.counters[it->second];
+            merged.push_back({counter.value, counter.count + match.count, counter.error + match.error});
+        }
+        else
+        {
+            merged.push_back({counter.value, counter.count + min_other, counter.error + min_other});
+        }
+    }
+    for(auto const& counter : other.counters)
+    {
+        if(positions.count(counter.value) == 0)
+        {
+            merged.push_back({counter.value, counter.count + min_this, counter.error + min_this});
+        }
+    }
+
+    std::size_t n_kept = std::min(n_counters, merged.size());
+    std::partial_sort(merged.begin(), merged.begin() + n_kept, merged.end(), [](Counter const& lhs, Counter const& rhs) { return lhs.count > rhs.count; });
+    merged.resize(n_kept);
+
+    counters = std::move(merged);
+    positions.clear();
+    by_count.clear();
+    for(std::size_t i{0}; i < counters.size(); ++i)
+    {
+        positions.emplace(counters[i].value, i);
+        by_count.insert({counters[i].count, i});
+    }
+}
+
+std::vector<DF::SpaceSaving::Counter> DF::SpaceSaving::top(std::size_t k) const
+{
+    std::vector<Counter> v_top = counters;
+    std::sort(v_top.begin(), v_top.end(), [](Counter const& lhs, Counter const& rhs)
+    {
+        return lhs.count != rhs.count ? lhs.count > rhs.count : lhs.value < rhs.value;
+    });
+    if(v_top.size() > k) v_top.resize(k);
+
+    return v_top;
+}
+
+DF::ColumnSketch::ColumnSketch(SketchOptions const& options)
+    : distinct(options.hll_precision), numbers(options.compression), frequent(options.n_counters)
+{
+}
+
+void DF::ColumnSketch::add(std::string_view cell)
+{
+    if(DF::is_missing(cell))
+    {
+        ++n_missing;
+        return;
+    }
+
+    ++n_values;
+    distinct.add(cell);
+    frequent.add(cell);
+
+    // numbers as the typed readers see them (DF::parse_cell<double>)
+    double value;
+    if(DF::try_parse_cell(cell, value))
+    {
+        ++n_numbers;
+        numbers.add(value);
+    }
+}
+
+void DF::ColumnSketch::merge(ColumnSketch const& other)
+{
+    n_values += other.n_values;
+    n_missing += other.n_missing;
+    n_numbers += other.n_numbers;
+    distinct.merge(other.distinct);
+    numbers.merge(other.numbers);
+    frequent.merge(other.frequent);
+}
+
+DF::Profile::Profile(SketchOptions sketch_options)
+    : options(sketch_options)
+{
+}
+
+DF::ColumnSketch& DF::Profile::get_or_add(std::string const& hdr)
+{
+    auto it = std::find(headers.begin(), headers.end(), hdr);
+    if(it != headers.end()) return sketches[it - headers.begin()];
+
+    headers.push_back(hdr);
+    sketches.emplace_back(options);
+    return sketches.back();
+}
+
+void DF::Profile::add(DataFrame const& df, std::shorts::V_string const& hdrs)
+{
+    std::shorts::V_string v_hdrs = hdrs.empty() ? df.get_headers() : hdrs;
+    std::vector<std::shorts::Column const*> v_cols;
+    for(auto const& hdr : v_hdrs) v_cols.push_back(&df.at(hdr));
+
+    std::size_t n = v_cols.empty() ? 0 : v_cols[0]->size();
+    std::size_t n_chunks = std::max<std::size_t>(1, std::min(DF::default_n_threads(), n / (1 << 14)));
+    std::size_t chunk = (n + n_chunks - 1) / n_chunks;
+
+    // one sketch per column and block of rows, merged afterwards
+    std::vector<ColumnSketch> partial(v_cols.size() * n_chunks, ColumnSketch(options));
+    DF::parallel_tasks(partial.size(), [&](std::size_t i_task)
+    {
+        std::size_t i_col = i_task / n_chunks;
+        std::size_t begin = (i_task % n_chunks) * chunk;
+        std::size_t end = std::min(n, begin + chunk);
+        for(std::size_t i_row{begin}; i_row < end; ++i_row) partial[i_task].add((*v_cols[i_col])[i_row]);
+    });
+
+    for(std::size_t i_col{0}; i_col < v_cols.size(); ++i_col)
+    {
+        auto& sketch = get_or_add(v_hdrs[i_col]);
+        for(std::size_t i_chunk{0}; i_chunk < n_chunks; ++i_chunk) sketch.merge(partial[i_col * n_chunks + i_chunk]);
+    }
+}
+
+void DF::Profile::add_file(std::string_view path, char delim, bool is_first_col_header, std::shorts::V_string v_hdrs)
+{
+    std::ifstream ifs(std::string(path), std::ios::binary);
+    if(ifs.fail())
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: unable to read file {}.\nPlease check your input.", path));
+    }
+
+    std::size_t n_threads = DF::default_n_threads();
+    std::vector<std::vector<ColumnSketch>> partial(n_threads);
+    std::shorts::V_string v_file_hdrs;
+    std::string block;
+    std::string rest;
+
+    while(true)
+    {
+        // read a block, only its complete lines are sketched, the rest starts the next block
+        block.swap(rest);
+        std::size_t n_kept = block.size();
+        block.resize(n_kept + block_size);
+        ifs.read(block.data() + n_kept, static_cast<std::streamsize>(block_size));
+        block.resize(n_kept + static_cast<std::size_t>(ifs.gcount()));
+        bool is_last = !ifs;
+
+        std::size_t n_complete = is_last ? block.size() : block.rfind('\n') + 1;
+        rest.assign(block, n_complete, std::string::npos);
+        block.resize(n_complete);
+
+        std::string_view lines(block);
+        if(v_file_hdrs.empty())
+        {
+            // the first line sets up the columns
+            std::size_t first = lines.find_first_not_of("\r\n");
+            if(first == std::string_view::npos)
+            {
+                if(is_last) break;
+                continue;
+            }
+
+            std::size_t line_end = std::min(lines.find('\n', first), lines.size());
+            std::string_view line = lines.substr(first, line_end - first);
+            if(!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+            std::string cell;
+            std::shorts::V_string cells;
+            for_each_cell(line, delim, cell, [&](std::size_t, std::string_view value) { cells.emplace_back(value); });
+
+            if(is_first_col_header)
+            {
+                v_file_hdrs = std::move(cells);
+                lines.remove_prefix(std::min(line_end + 1, lines.size()));
+            }
+            else if(!v_hdrs.empty())
+            {
+                if(v_hdrs.size() != cells.size())
+                {
+                    throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: number of provided headers does not match with the number of columns in the data"));
+                }
+                v_file_hdrs = v_hdrs;
+            }
+            else
+            {
+                for(std::size_t i_col{0}; i_col < cells.size(); ++i_col) v_file_hdrs.push_back(std::to_string(i_col + 1));
+            }
+
+            for(auto& sketches : partial) sketches.assign(v_file_hdrs.size(), ColumnSketch(options));
+        }
+
+        // split the block at line ends, one part per thread
+        std::vector<std::size_t> v_bounds{0};
+        for(std::size_t i_part{1}; i_part < n_threads; ++i_part)
+        {
+            std::size_t pos = std::max(v_bounds.back(), lines.size() * i_part / n_threads);
+            pos = pos >= lines.size() ? lines.size() : std::min(lines.find('\n', pos), lines.size());
+            v_bounds.push_back(pos == lines.size() ? pos : pos + 1);
+        }
+        v_bounds.push_back(lines.size());
+
+        DF::parallel_tasks(n_threads, [&](std::size_t i_part)
+        {
+            auto& sketches = partial[i_part];
+            std::string cell;
+            std::size_t pos = v_bounds[i_part];
+            while(pos < v_bounds[i_part + 1])
+            {
+                std::size_t line_end = std::min(lines.find('\n', pos), v_bounds[i_part + 1]);
+                std::string_view line = lines.substr(pos, line_end - pos);
+                pos = line_end + 1;
+
+                if(!line.empty() && line.back() == '\r') line.remove_suffix(1);
+                if(line.empty()) continue;
+
+                std::size_t n_cells = for_each_cell(line, delim, cell, [&](std::size_t i_col, std::string_view value)
+                {
+                    if(i_col < sketches.size()) sketches[i_col].add(value);
+                });
+                if(n_cells != sketches.size())
+                {
+                    throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: inconsistent number of columns in {}", path));
+                }
+            }
+        }, n_threads);
+
+        if(is_last) break;
+    }
+
+    for(auto const& sketches : partial)
+    {
+        for(std::size_t i_col{0}; i_col < sketches.size(); ++i_col) get_or_add(v_file_hdrs[i_col]).merge(sketches[i_col]);
+    }
+}
+
+void DF::Profile::merge(Profile const& other)
+{
+    for(std::size_t i_col{0}; i_col < other.headers.size(); ++i_col)
+    {
+        get_or_add(other.headers[i_col]).merge(other.sketches[i_col]);
+    }
+}
+
+DF::DataFrame DF::Profile::summary() const
+{
+    std::shorts::V_string v_count, v_missing, v_nunique, v_numbers, v_min, v_q25, v_median, v_q75, v_max;
+    for(auto const& sketch : sketches)
+    {
+        v_count.push_back(std::to_string(sketch.n_values));
+        v_missing.push_back(std::to_string(sketch.n_missing));
+        v_nunique.push_back(std::to_string(std::llround(sketch.distinct.estimate())));
+        v_numbers.push_back(std::to_string(sketch.n_numbers));
+        v_min.push_back(DF::to_cell(sketch.numbers.min()));
+        v_q25.push_back(DF::to_cell(sketch.numbers.quantile(0.25)));
+        v_median.push_back(DF::to_cell(sketch.numbers.quantile(0.5)));
+        v_q75.push_back(DF::to_cell(sketch.numbers.quantile(0.75)));
+        v_max.push_back(DF::to_cell(sketch.numbers.max()));
+    }
+
+    DF::DataFrame result;
+    result.add_col(headers, "column");
+    result.add_col(std::move(v_count), "count");
+    result.add_col(std::move(v_missing), "missing");
+    result.add_col(std::move(v_nunique), "nunique");
+    result.add_col(std::move(v_numbers), "numbers");
+    result.add_col(std::move(v_min), "min");
+    result.add_col(std::move(v_q25), "q25");
+    result.add_col(std::move(v_median), "median");
+    result.add_col(std::move(v_q75), "q75");
+    result.add_col(std::move(v_max), "max");
+    result.n_rows = sketches.size();
+
+    return result;
+}
+
+DF::DataFrame DF::Profile::quantiles(std::string const& hdr, std::shorts::V_double const& qs) const
+{
+    auto const& sketch = at(hdr);
+
+    std::shorts::V_string v_qs, v_values;
+    for(auto q : qs)
+    {
+        v_qs.push_back(DF::to_cell(q));
+        v_values.push_back(DF::to_cell(sketch.numbers.quantile(q)));
+    }
+
+    DF::DataFrame result;
+    result.add_col(std::move(v_qs), "q");
+    result.add_col(std::move(v_values), "value");
+    result.n_rows = qs.size();
+
+    return result;
+}
+
+DF::DataFrame DF::Profile::top_k(std::string const& hdr, std::size_t k) const
+{
+    auto v_top = at(hdr).frequent.top(k);
+
+    std::shorts::V_string v_values, v_counts, v_errors;
+    for(auto const& counter : v_top)
+    {
+        v_values.push_back(counter.value);
+        v_counts.push_back(std::to_string(counter.count));
+        v_errors.push_back(std::to_string(counter.error));
+    }
+
+    DF::DataFrame result;
+    result.add_col(std::move(v_values), "value");
+    result.add_col(std::move(v_counts), "count");
+    result.add_col(std::move(v_errors), "error");
+    result.n_rows = v_top.size();
+
+    return result;
+}
+
+DF::ColumnSketch const& DF::Profile::at(std::string const& hdr) const
+{
+    auto it = std::find(headers.begin(), headers.end(), hdr);
+    if(it == headers.end())
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: the profile has no column {}", hdr));
+    }
+
+    return sketches[it - headers.begin()];
+}
+
+std::shorts::V_string DF::Profile::get_headers() const
+{
+    return headers;
+}
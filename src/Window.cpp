@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include "Parallel.hpp"
+#include <stdexcept>
+#include <unordered_map>
+#include "Window.hpp"
+
+namespace
+{
+    constexpr double nan_value = std::numeric_limits<double>::quiet_NaN();
+
+    /**
+     * @brief count, mean and sum of squared deviations of a window (Welford), values can be added and removed
+     *
+     */
+    struct WindowMoments
+    {
+        std::size_t n = 0;
+        double mean = 0.0;
+        double m2 = 0.0;
+
+        void add(double x)
+        {
+            ++n;
+            double delta = x - mean;
+            mean += delta / static_cast<double>(n);
+            m2 += delta * (x - mean);
+        }
+
+        void remove(double x)
+        {
+            if(--n == 0)
+            {
+                mean = 0.0;
+                m2 = 0.0;
+                return;
+            }
+            double delta = x - mean;
+            mean -= delta / static_cast<double>(n);
+            m2 = std::max(0.0, m2 - delta * (x - mean));
+        }
+    };
+
+    // a column is ordered numerically if all its cells are numbers or missing
+    bool try_parse_numbers(std::shorts::Column const& values, std::shorts::V_double& v_numbers)
+    {
+        v_numbers.resize(values.size());
+        for(std::size_t i{0}; i < values.size(); ++i)
+        {
+            try
+            {
+                v_numbers[i] = DF::parse_cell<double>(values[i]);
+            }
+            catch(std::runtime_error const&)
+            {
+                v_numbers.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+DF::Rolling::Rolling(std::shorts::V_double v_values, std::size_t window_size, std::size_t min_values)
+    : values(std::move(v_values)), window(window_size), min_periods(min_values == 0 ? window_size : min_values)
+{
+    if(window == 0)
+    {
+        throw std::runtime_error(fmt::format(fg(fmt::color::red), "Error: the window of rolling must contain at least one row"));
+    }
+}
+
+std::shorts::V_double DF::Rolling::sum() const
+{
+    std::shorts::V_double v_results(values.size());
+    double sum = 0.0;
+    std::size_t n = 0;
+
+    for(std::size_t i{0}; i < values.size(); ++i)
+    {
+        if(!std::isnan(values[i]))
+        {
+            sum += values[i];
+            ++n;
+        }
+        if(i >= window && !std::isnan(values[i - window]))
+        {
+            sum -= values[i - window];
+            --n;
+        }
+        v_results[i] = n >= min_periods ? sum : nan_value;
+    }
+
+    return v_results;
+}
+
+std::shorts::V_double DF::Rolling::mean() const
+{
+    std::shorts::V_double v_results(values.size());
+    WindowMoments moments;
+
+    for(std::size_t i{0}; i < values.size(); ++i)
+    {
+        if(!std::isnan(values[i])) moments.add(values[i]);
+        if(i >= window && !std::isnan(values[i - window])) moments.remove(values[i - window]);
+        v_results[i] = moments.n >= min_periods && moments.n > 0 ? moments.mean : nan_value;
+    }
+
+    return v_results;
+}
+
+std::shorts::V_double DF::Rolling::std() const
+{
+    std::shorts::V_double v_results(values.size());
+    WindowMoments moments;
+
+    for(std::size_t i{0}; i < values.size(); ++i)
+    {
+        if(!std::isnan(values[i])) moments.add(values[i]);
+        if(i >= window && !std::isnan(values[i - window])) moments.remove(values[i - window]);
+        v_results[i] = moments.n >= min_periods && moments.n > 1 ? std::sqrt(moments.m2 / static_cast<double>(moments.n - 1)) : nan_value;
+    }
+
+    return v_results;
+}
+
+std::shorts::V_double DF::Rolling::count() const
+{
+    std::shorts::V_double v_results(values.size());
+    std::size_t n = 0;
+
+    for(std::size_t i{0}; i < values.size(); ++i)
+    {
+        if(!std::isnan(values[i])) ++n;
+        if(i >= window && !std::isnan(values[i - window])) --n;
+        v_results[i] = static_cast<double>(n);
+    }
+
+    return v_results;
+}
+
+template<typename IsBetter>
+std::shorts::V_double DF::Rolling::extreme(IsBetter is_better) const
+{
+    // monotonic deque: positions of candidate extremes, their values get worse from front to back
+    std::shorts::V_double v_results(values.size());
+    std::deque<std::size_t> candidates;
+    std::size_t n = 0;
+
+    for(std::size_t i{0}; i < values.size(); ++i)
+    {
+        if(!std::isnan(values[i]))
+        {
+            while(!candidates.empty() && !is_better(values[candidates.back()], values[i])) candidates.pop_back();
+            candidates.push_back(i);
+            ++n;
+        }
+        if(i >= window)
+        {
+            if(!std::isnan(values[i - window])) --n;
+            if(!candidates.empty() && candidates.front() == i - window) candidates.pop_front();
+        }
+        v_results[i] = n >= min_periods && !candidates.empty() ? values[candidates.front()] : nan_value;
+    }
+
+    return v_results;
+}
+
+std::shorts::V_double DF::Rolling::min() const
+{
+    return extreme([](double lhs, double rhs) { return lhs < rhs; });
+}
+
+std::shorts::V_double DF::Rolling::max() const
+{
+    return extreme([](double lhs, double rhs) { return lhs > rhs; });
+}
+
+DF::Rolling DF::DataFrame::rolling(std::string const& hdr, std::size_t window, std::size_t min_periods) const
+{
+    return DF::Rolling(DF::parse_column<double>(at(hdr), hdr), window, min_periods);
+}
+
+DF::Window::Window(DataFrame const& data_frame, std::shorts::V_string const& partition_by, std::shorts::V_string const& order_by)
+    : df(&data_frame)
+{
+    std::vector<std::shorts::Column const*> v_keys;
+    for(auto const& hdr : partition_by) v_keys.push_back(&df->at(hdr));
+
+    std::size_t n = df->get_headers().empty() ? 0 : df->at(df->get_headers()[0]).size();
+
+    // hash partitioning, partitions are numbered in order of their first row
+    std::unordered_map<std::string, std::size_t> partition_ids;
+    std::string key;
+    for(std::size_t i_row{0}; i_row < n; ++i_row)
+    {
+        key.clear();
+        for(auto const* col : v_keys)
+        {
+            key += (*col)[i_row];
+            key += '\x1f';
+        }
+
+        auto [it, is_new] = partition_ids.emplace(key, partitions.size());
+        if(is_new) partitions.emplace_back();
+        partitions[it->second].push_back(i_row);
+    }
+
+    for(auto const& hdr : order_by)
+    {
+        auto const& values = df->at(hdr);
+        std::shorts::V_double v_numbers;
+        if(try_parse_numbers(values, v_numbers))
+        {
+            order_numbers.push_back(std::move(v_numbers));
+            order_strings.push_back(nullptr);
+        }
+        else
+        {
+            order_numbers.emplace_back();
+            order_strings.push_back(&values);
+        }
+    }
+
+    if(order_by.empty()) return;
+
+    auto is_less = [this](std::size_t lhs, std::size_t rhs)
+    {
+        for(std::size_t i_key{0}; i_key < order_strings.size(); ++i_key)
+        {
+            if(order_strings[i_key] != nullptr)
+            {
+                auto const& values = *order_strings[i_key];
+                if(values[lhs] != values[rhs]) return values[lhs] < values[rhs];
+            }
+            else
+            {
+                // missing values are ordered last
+                double a = order_numbers[i_key][lhs];
+                double b = order_numbers[i_key][rhs];
+                if(std::isnan(a) || std::isnan(b))
+                {
+                    if(std::isnan(a) != std::isnan(b)) return std::isnan(b);
+                    continue;
+                }
+                if(a != b) return a < b;
+            }
+        }
+        return false;
+    };
+
+    DF::parallel_tasks(partitions.size(), [&](std::size_t i_part)
+    {
+        std::stable_sort(partitions[i_part].begin(), partitions[i_part].end(), is_less);
+    });
+}
+
+bool DF::Window::is_tie(std::size_t lhs, std::size_t rhs) const
+{
+    for(std::size_t i_key{0}; i_key < order_strings.size(); ++i_key)
+    {
+        if(order_strings[i_key] != nullptr)
+        {
+            if((*order_strings[i_key])[lhs] != (*order_strings[i_key])[rhs]) return false;
+        }
+        else
+        {
+            double a = order_numbers[i_key][lhs];
+            double b = order_numbers[i_key][rhs];
+            if(!(a == b || (std::isnan(a) && std::isnan(b)))) return false;
+        }
+    }
+    return true;
+}
+
+std::shorts::V_int DF::Window::row_number() const
+{
+    std::size_t n = df->get_headers().empty() ? 0 : df->at(df->get_headers()[0]).size();
+    std::shorts::V_int v_results(n);
+
+    DF::parallel_tasks(partitions.size(), [&](std::size_t i_part)
+    {
+        auto const& rows = partitions[i_part];
+        for(std::size_t i{0}; i < rows.size(); ++i) v_results[rows[i]] = static_cast<int>(i + 1);
+    });
+
+    return v_results;
+}
+
+std::shorts::V_int DF::Window::rank() const
+{
+    std::size_t n = df->get_headers().empty() ? 0 : df->at(df->get_headers()[0]).size();
+    std::shorts::V_int v_results(n);
+
+    DF::parallel_tasks(partitions.size(), [&](std::size_t i_part)
+    {
+        auto const& rows = partitions[i_part];
+        int current = 1;
+        for(std::size_t i{0}; i < rows.size(); ++i)
+        {
+            if(i > 0 && !is_tie(rows[i - 1], rows[i])) current = static_cast<int>(i + 1);
+            v_results[rows[i]] = current;
+        }
+    });
+
+    return v_results;
+}
+
+std::shorts::V_string DF::Window::shift(std::string const& hdr, long long n, std::string const& fill) const
+{
+    auto const& values = df->at(hdr);
+    std::shorts::V_string v_results(values.size(), fill);
+
+    DF::parallel_tasks(partitions.size(), [&](std::size_t i_part)
+    {
+        auto const& rows = partitions[i_part];
+        auto size = static_cast<long long>(rows.size());
+        for(long long i{0}; i < size; ++i)
+        {
+            long long j = i - n;
+            if(j >= 0 && j < size) v_results[rows[i]] = values[rows[j]];
+        }
+    });
+
+    return v_results;
+}
+
+std::shorts::V_string DF::Window::lag(std::string const& hdr, std::size_t n, std::string const& fill) const
+{
+    return shift(hdr, static_cast<long long>(n), fill);
+}
+
+std::shorts::V_string DF::Window::lead(std::string const& hdr, std::size_t n, std::string const& fill) const
+{
+    return shift(hdr, -static_cast<long long>(n), fill);
+}
+
+std::shorts::V_double DF::Window::cumsum(std::string const& hdr) const
+{
+    auto v_values = DF::parse_column<double>(df->at(hdr), hdr);
+    std::shorts::V_double v_results(v_values.size());
+
+    DF::parallel_tasks(partitions.size(), [&](std::size_t i_part)
+    {
+        double sum = 0.0;
+        for(auto i_row : partitions[i_part])
+        {
+            if(!std::isnan(v_values[i_row])) sum += v_values[i_row];
+            v_results[i_row] = std::isnan(v_values[i_row]) ? nan_value : sum;
+        }
+    });
+
+    return v_results;
+}
+
+std::shorts::V_double DF::Window::rolling_mean(std::string const& hdr, std::size_t window, std::size_t min_periods) const
+{
+    auto v_values = DF::parse_column<double>(df->at(hdr), hdr);
+    std::shorts::V_double v_results(v_values.size());
+
+    DF::parallel_tasks(partitions.size(), [&](std::size_t i_part)
+    {
+        auto const& rows = partitions[i_part];
+        std::shorts::V_double v_part(rows.size());
+        for(std::size_t i{0}; i < rows.size(); ++i) v_part[i] = v_values[rows[i]];
+
+        auto v_means = DF::Rolling(std::move(v_part), window, min_periods).mean();
+        for(std::size_t i{0}; i < rows.size(); ++i) v_results[rows[i]] = v_means[i];
+    });
+
+    return v_results;
+}
+
+std::vector<std::vector<std::size_t>> const& DF::Window::get_partitions() const
+{
+    return partitions;
+}
+
+DF::Window DF::DataFrame::over(std::shorts::V_string const& partition_by, std::shorts::V_string const& order_by) const
+{
+    return DF::Window(*this, partition_by, order_by);
+}